@@ -0,0 +1,292 @@
+// benchmark of the avl tree family
+#include "src/test_utils.h"
+#include <micro-containers/avl_tree.h>
+#include <micro-containers/dictionary.h>
+#include <micro-containers/ordered_set.h>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+using namespace microc;
+using clock_type = std::chrono::high_resolution_clock;
+
+double ns_since(clock_type::time_point start) {
+    return double(std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now() - start).count());
+}
+
+std::vector<int> random_keys(int count) {
+    std::vector<int> keys(count);
+    unsigned int x = 2463534242u; // xorshift state
+    for (auto & key : keys) { x ^= x << 13; x ^= x >> 17; x ^= x << 5; key = int(x >> 1); }
+    return keys;
+}
+
+std::vector<int> sequential_keys(int count) {
+    std::vector<int> keys(count);
+    for (int ix = 0; ix < count; ++ix) keys[ix] = ix;
+    return keys;
+}
+
+template<class container_type, class Insert>
+void bench_insert(const char * name, const char * order, const std::vector<int> & keys,
+                  const Insert & insert) {
+    container_type container;
+    auto start = clock_type::now();
+    for (const auto key : keys) insert(container, key);
+    const double insert_ns = ns_since(start);
+    start = clock_type::now();
+    for (const auto key : keys) container.erase(key);
+    const double erase_ns = ns_since(start);
+    std::printf("%-12s %-10s n %8zu  insert ns/op %8.2f  erase ns/op %8.2f\n", name, order,
+                keys.size(), insert_ns / double(keys.size()), erase_ns / double(keys.size()));
+}
+
+struct tree_adapter : avl_tree<int> {
+    void erase(int key) { remove(key); }
+};
+
+void bench_insertion() {
+    print_test_header("bench_insertion");
+    const int count = 1<<20;
+    const std::vector<int> random = random_keys(count), sequential = sequential_keys(count);
+    auto tree_insert = [](tree_adapter & tree, int key) { tree.insert(key); };
+    auto dict_insert = [](dictionary<int, int> & dict, int key) { dict.insert(pair<int, int>(key, key)); };
+    auto set_insert = [](ordered_set<int> & set, int key) { set.insert(key); };
+    bench_insert<tree_adapter>("avl_tree", "random", random, tree_insert);
+    bench_insert<tree_adapter>("avl_tree", "sequential", sequential, tree_insert);
+    bench_insert<dictionary<int, int>>("dictionary", "random", random, dict_insert);
+    bench_insert<dictionary<int, int>>("dictionary", "sequential", sequential, dict_insert);
+    bench_insert<ordered_set<int>>("ordered_set", "random", random, set_insert);
+    bench_insert<ordered_set<int>>("ordered_set", "sequential", sequential, set_insert);
+}
+
+template<class container_type, class Insert>
+void bench_iterate(const char * name, const std::vector<int> & keys, const Insert & insert) {
+    container_type container;
+    for (const auto key : keys) insert(container, key);
+    long sink = 0;
+    auto start = clock_type::now();
+    for (const auto & item : container) sink += ((long)&item >> 4) & 1;
+    const double forward_ns = ns_since(start);
+    start = clock_type::now();
+    for (auto it = container.end(); it != container.begin();) { --it; sink += ((long)&*it >> 4) & 1; }
+    const double backward_ns = ns_since(start);
+    std::printf("%-12s n %8zu  forward ns/op %6.2f  backward ns/op %6.2f  (%ld)\n", name, keys.size(),
+                forward_ns / double(keys.size()), backward_ns / double(keys.size()), sink);
+}
+
+void bench_iteration() {
+    print_test_header("bench_iteration");
+    const std::vector<int> random = random_keys(1<<20);
+    bench_iterate<tree_adapter>("avl_tree", random, [](tree_adapter & tree, int key) { tree.insert(key); });
+    bench_iterate<dictionary<int, int>>("dictionary", random,
+            [](dictionary<int, int> & dict, int key) { dict.insert(pair<int, int>(key, key)); });
+    bench_iterate<ordered_set<int>>("ordered_set", random, [](ordered_set<int> & set, int key) { set.insert(key); });
+}
+
+// times clear(), the destructor and move assignment over a filled container
+template<class container_type, class Insert>
+void bench_teardown(const char * name, const std::vector<int> & keys, const Insert & insert) {
+    double clear_ns, destroy_ns, move_ns;
+    {
+        container_type container;
+        for (const auto key : keys) insert(container, key);
+        auto start = clock_type::now();
+        container.clear();
+        clear_ns = ns_since(start);
+    }
+    {
+        auto * container = new container_type();
+        for (const auto key : keys) insert(*container, key);
+        auto start = clock_type::now();
+        delete container;
+        destroy_ns = ns_since(start);
+    }
+    {
+        container_type container, other;
+        for (const auto key : keys) insert(container, key);
+        auto start = clock_type::now();
+        container = microc::traits::move(other);
+        move_ns = ns_since(start);
+    }
+    const double n = double(keys.size());
+    std::printf("%-12s n %8zu  clear ns/op %6.2f  destructor ns/op %6.2f  move assign ns/op %6.2f\n",
+                name, keys.size(), clear_ns / n, destroy_ns / n, move_ns / n);
+}
+
+void bench_teardown() {
+    print_test_header("bench_teardown");
+    const std::vector<int> random = random_keys(1<<20);
+    bench_teardown<tree_adapter>("avl_tree", random, [](tree_adapter & tree, int key) { tree.insert(key); });
+    bench_teardown<dictionary<int, int>>("dictionary", random,
+            [](dictionary<int, int> & dict, int key) { dict.insert(pair<int, int>(key, key)); });
+    bench_teardown<ordered_set<int>>("ordered_set", random, [](ordered_set<int> & set, int key) { set.insert(key); });
+}
+
+// building from sorted data, item by item versus assign_sorted, and merging sorted ranges
+void bench_bulk_build() {
+    print_test_header("bench_bulk_build");
+    const int count = 1<<20;
+    std::vector<pair<int, int>> items, odd_items;
+    for (int ix = 0; ix < count; ++ix) {
+        items.push_back(pair<int, int>(2 * ix, ix));
+        odd_items.push_back(pair<int, int>(2 * ix + 1, ix));
+    }
+    const double n = double(count);
+    {
+        dictionary<int, int> dict;
+        auto start = clock_type::now();
+        for (const auto & item : items) dict.insert(item);
+        std::printf("dictionary  n %8d  insert one by one ns/op %7.2f\n", count, ns_since(start) / n);
+    }
+    {
+        dictionary<int, int> dict;
+        auto start = clock_type::now();
+        dict.assign_sorted(items.begin(), items.end());
+        std::printf("dictionary  n %8d  assign_sorted ns/op %7.2f\n", count, ns_since(start) / n);
+        start = clock_type::now();
+        dict.insert_sorted(odd_items.begin(), odd_items.end());
+        std::printf("dictionary  n %8d  insert_sorted interleaved ns/op %7.2f\n", count, ns_since(start) / n);
+    }
+    {
+        dictionary<int, int> dict;
+        dict.assign_sorted(items.begin(), items.end());
+        auto start = clock_type::now();
+        for (const auto & item : odd_items) dict.insert(item);
+        std::printf("dictionary  n %8d  insert interleaved one by one ns/op %7.2f\n", count, ns_since(start) / n);
+    }
+}
+
+// merging a small set into a large one, item by item versus union_with, and intersecting a small set with it
+void bench_set_operations() {
+    print_test_header("bench_set_operations");
+    const std::vector<int> large_keys = random_keys(1<<20);
+    for (const int small : { 1<<6, 1<<12, 1<<18 }) {
+        const std::vector<int> small_keys(large_keys.begin(), large_keys.begin() + small);
+        std::vector<int> other_keys = random_keys(small + (1<<20));
+        other_keys.erase(other_keys.begin(), other_keys.begin() + (1<<20));
+        ordered_set<int> large_1, large_2, large_3, small_1, small_2;
+        for (const auto key : large_keys) { large_1.insert(key); large_2.insert(key); large_3.insert(key); }
+        for (const auto key : other_keys) small_1.insert(key);
+        for (const auto key : small_keys) small_2.insert(key);
+        auto start = clock_type::now();
+        for (const auto key : small_1) large_1.insert(key);
+        const double insert_ns = ns_since(start);
+        start = clock_type::now();
+        large_2.union_with(small_1);
+        const double union_ns = ns_since(start);
+        start = clock_type::now();
+        small_2.intersect_with(large_3);
+        const double intersect_ns = ns_since(start);
+        std::printf("n %8d  m %7d  insert one by one us %9.1f  union_with us %9.1f  intersect_with us %9.1f\n",
+                    1<<20, small, insert_ns / 1000, union_ns / 1000, intersect_ns / 1000);
+    }
+}
+
+// keys in order, and nearly in order as timestamps of events arrive, with and without a hint
+template<class container_type, class Insert>
+double bench_hinted(const std::vector<int> & keys, const Insert & insert) {
+    container_type container;
+    auto start = clock_type::now();
+    insert(container, keys);
+    const double ns = ns_since(start) / double(keys.size());
+    return container.size()==keys.size() ? ns : -1;
+}
+
+void bench_hinted_insert() {
+    print_test_header("bench_hinted_insert");
+    const int count = 1<<20;
+    std::vector<int> sequential = sequential_keys(count), nearly = sequential_keys(count);
+    // swap a few neighbours, a late event lands a little before the last one
+    for (int ix = 0; ix + 1 < count; ix += 7) { const int key = nearly[ix]; nearly[ix] = nearly[ix + 1]; nearly[ix + 1] = key; }
+    using dict = dictionary<int, int>;
+    auto no_hint = [](dict & d, const std::vector<int> & keys) {
+        for (const auto key : keys) d.insert(pair<int, int>(key, key));
+    };
+    auto end_hint = [](dict & d, const std::vector<int> & keys) {
+        for (const auto key : keys) d.insert(d.cend(), pair<int, int>(key, key));
+    };
+    auto last_hint = [](dict & d, const std::vector<int> & keys) {
+        auto hint = d.end();
+        for (const auto key : keys) hint = d.insert(hint, pair<int, int>(key, key));
+    };
+    using ordered_dict = dictionary<int, int, dict_less<int>, std_allocator<char>, avl_order_statistics_backend>;
+    auto ordered_last_hint = [](ordered_dict & d, const std::vector<int> & keys) {
+        auto hint = d.end();
+        for (const auto key : keys) hint = d.insert(hint, pair<int, int>(key, key));
+    };
+    const char * names[] = { "sequential", "nearly" };
+    const std::vector<int> * inputs[] = { &sequential, &nearly };
+    for (int ix = 0; ix < 2; ++ix) {
+        std::printf("%-10s n %8d  insert ns/op %6.2f  hint end ns/op %6.2f  hint last ns/op %6.2f  "
+                    "order statistics hint last ns/op %6.2f\n", names[ix], count,
+                    bench_hinted<dict>(*inputs[ix], no_hint), bench_hinted<dict>(*inputs[ix], end_hint),
+                    bench_hinted<dict>(*inputs[ix], last_hint),
+                    bench_hinted<ordered_dict>(*inputs[ix], ordered_last_hint));
+    }
+    // string keys with a long common prefix, where a comparison costs more than a step down
+    std::vector<std::string> names_in_order;
+    char name[32];
+    for (int ix = 0; ix < count; ++ix) {
+        std::snprintf(name, sizeof(name), "sensor/events/%08d", ix);
+        names_in_order.push_back(name);
+    }
+    using string_set = ordered_set<std::string>;
+    double string_ns[2];
+    for (int hinted = 0; hinted < 2; ++hinted) {
+        string_set set;
+        auto start = clock_type::now();
+        auto hint = set.end();
+        for (const auto & key : names_in_order)
+            if (hinted) hint = set.insert(hint, key);
+            else set.insert(key);
+        string_ns[hinted] = ns_since(start) / double(count);
+    }
+    std::printf("%-10s n %8d  insert ns/op %6.2f  hint last ns/op %6.2f\n", "strings", count,
+                string_ns[0], string_ns[1]);
+}
+
+// expiring a window of old keys, as a time to live cache does, and cutting a slice from the middle,
+// key by key versus erase_range, which splits the range out and joins the rest
+void bench_erase_range() {
+    print_test_header("bench_erase_range");
+    const int count = 1<<20;
+    for (const int slice : { 1<<4, 1<<10, 1<<16 }) {
+        dictionary<int, int> dict_1, dict_2;
+        // filled one after the other, so the nodes of each are not interleaved in memory
+        for (int ix = 0; ix < count; ++ix) dict_1.insert(pair<int, int>(ix, ix));
+        for (int ix = 0; ix < count; ++ix) dict_2.insert(pair<int, int>(ix, ix));
+        // expire the oldest slice of keys, until half of them are gone
+        auto start = clock_type::now();
+        for (int from = 0; from < count / 2; from += slice)
+            for (int key = from; key < from + slice; ++key) dict_1.erase(key);
+        const double one_by_one_ns = ns_since(start);
+        start = clock_type::now();
+        for (int from = 0; from < count / 2; from += slice)
+            dict_2.erase_range(from, from + slice);
+        const double range_ns = ns_since(start);
+        // and a slice from the middle of what is left
+        const int middle = count / 2 + count / 4;
+        start = clock_type::now();
+        for (int key = middle; key < middle + slice; ++key) dict_1.erase(key);
+        const double middle_one_by_one_ns = ns_since(start);
+        start = clock_type::now();
+        dict_2.erase_range(middle, middle + slice);
+        const double middle_range_ns = ns_since(start);
+        std::printf("slice %6d  expire one by one us %8.1f  erase_range us %8.1f  "
+                    "middle one by one us %8.1f  erase_range us %8.1f  (%zu, %zu)\n", slice,
+                    one_by_one_ns / 1000, range_ns / 1000, middle_one_by_one_ns / 1000,
+                    middle_range_ns / 1000, (size_t)dict_1.size(), (size_t)dict_2.size());
+    }
+}
+
+int main() {
+    bench_insertion();
+    bench_iteration();
+    bench_teardown();
+    bench_bulk_build();
+    bench_set_operations();
+    bench_erase_range();
+    bench_hinted_insert();
+}
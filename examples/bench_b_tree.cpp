@@ -0,0 +1,75 @@
+// benchmark of the b_tree versus the avl_tree, as backends of dictionary and ordered_set
+#include "src/test_utils.h"
+#include <micro-containers/dictionary.h>
+#include <micro-containers/ordered_set.h>
+#include <micro-containers/b_tree.h>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+using namespace microc;
+using clock_type = std::chrono::high_resolution_clock;
+
+double ns_since(clock_type::time_point start) {
+    return double(std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now() - start).count());
+}
+
+std::vector<int> random_keys(int count) {
+    std::vector<int> keys(count);
+    unsigned int x = 2463534242u; // xorshift state
+    for (auto & key : keys) { x ^= x << 13; x ^= x >> 17; x ^= x << 5; key = int(x >> 1); }
+    return keys;
+}
+
+// insert, lookup every key, scan everything and then erase, in ns per item
+template<class container_type, class Insert>
+void bench(const char * name, const std::vector<int> & keys, const Insert & insert) {
+    container_type container;
+    auto start = clock_type::now();
+    for (const auto key : keys) insert(container, key);
+    const double insert_ns = ns_since(start);
+    long sink = 0;
+    start = clock_type::now();
+    for (const auto key : keys) sink += container.contains(key);
+    const double lookup_ns = ns_since(start);
+    start = clock_type::now();
+    for (const auto & item : container) sink += ((long)&item >> 4) & 1;
+    const double scan_ns = ns_since(start);
+    start = clock_type::now();
+    for (const auto key : keys) container.erase(key);
+    const double erase_ns = ns_since(start);
+    const double n = double(keys.size());
+    std::printf("%-22s n %8zu  insert %7.2f  lookup %7.2f  scan %6.2f  erase %7.2f  (%ld)\n", name,
+                keys.size(), insert_ns / n, lookup_ns / n, scan_ns / n, erase_ns / n, sink);
+}
+
+struct insert_pair {
+    template<class dict_type> void operator()(dict_type & dict, int key) const { dict.insert(pair<int, int>(key, key)); }
+};
+struct insert_key {
+    template<class set_type> void operator()(set_type & set, int key) const { set.insert(key); }
+};
+
+void bench_dictionary(int count) {
+    const std::vector<int> keys = random_keys(count);
+    const insert_pair insert{};
+    bench<dictionary<int, int>>("dictionary avl", keys, insert);
+    bench<dictionary<int, int, dict_less<int>, std_allocator<char>, b_tree_backend<16>>>("dictionary b_tree<16>", keys, insert);
+    bench<dictionary<int, int, dict_less<int>, std_allocator<char>, b_tree_backend<32>>>("dictionary b_tree<32>", keys, insert);
+    bench<dictionary<int, int, dict_less<int>, std_allocator<char>, b_tree_backend<64>>>("dictionary b_tree<64>", keys, insert);
+}
+
+void bench_ordered_set(int count) {
+    const std::vector<int> keys = random_keys(count);
+    const insert_key insert{};
+    bench<ordered_set<int>>("ordered_set avl", keys, insert);
+    bench<ordered_set<int, ordered_set_less<int>, std_allocator<char>, b_tree_backend<32>>>("ordered_set b_tree<32>", keys, insert);
+    bench<ordered_set<int, ordered_set_less<int>, std_allocator<char>, b_tree_backend<64>>>("ordered_set b_tree<64>", keys, insert);
+}
+
+int main() {
+    print_test_header("bench_b_tree, ns per item");
+    bench_dictionary(1<<16);
+    bench_dictionary(1<<20);
+    bench_ordered_set(1<<20);
+}
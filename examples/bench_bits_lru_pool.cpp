@@ -0,0 +1,40 @@
+// benchmark of the packed and the wide index layouts of bits_robin_lru_pool, over uniform keys.
+// usage:
+//   bench_bits_lru_pool           - 10 and 20 bits pools
+//   bench_bits_lru_pool --huge    - also a 26 bits wide pool, its index takes 1.5GB
+#include "src/test_utils.h"
+#include <micro-containers/bits_robin_lru_pool.h>
+#include <chrono>
+#include <cstring>
+
+template<class pool_type>
+void benchmark_pool(const char * name, int ops, unsigned long key_range) {
+    pool_type pool{0.5f};
+    unsigned long x = 88172645463325252ul; // xorshift state
+    auto start = std::chrono::high_resolution_clock::now();
+    long sink=0;
+    for (int ix = 0; ix < ops; ++ix) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        sink += pool.get_or_put(long(x % key_range)).value;
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    std::cout << "- " << name << ": capacity " << pool.capacity()
+              << ", bytes/entry " << pool_type::item_type_size
+              << ", index MB " << ((pool_type::item_type_size * pool.capacity())>>20)
+              << ", ops/sec " << (long long)(double(ops) * 1e9 / double(ns))
+              << " (" << sink << ")" << std::endl;
+}
+
+int main(int argc, char ** argv) {
+    print_test_header("bench_bits_lru_pool");
+    const int ops = 1<<22;
+    using alloc = microc::std_allocator<char>;
+    benchmark_pool<bits_robin_lru_pool<20, long, alloc>>("packed 20 bits, long", ops, 1<<20);
+    benchmark_pool<bits_robin_lru_pool<20, long, alloc, true>>("wide 20 bits, long", ops, 1<<20);
+    benchmark_pool<bits_robin_lru_pool<10, int, alloc>>("packed 10 bits, int", ops, 1<<10);
+    benchmark_pool<bits_robin_lru_pool<10, int, alloc, true>>("wide 10 bits, int", ops, 1<<10);
+    if (argc > 1 && std::strcmp(argv[1], "--huge") == 0)
+        benchmark_pool<bits_robin_lru_pool<26, long, alloc, true>>("wide 26 bits, long", ops, 1<<26);
+    return 0;
+}
@@ -0,0 +1,92 @@
+// benchmark of concurrent inserts and scans, concurrent_map versus a dictionary behind a mutex
+#include "src/test_utils.h"
+#include <micro-containers/concurrent_map.h>
+#include <micro-containers/dictionary.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace microc;
+using clock_type = std::chrono::high_resolution_clock;
+
+double ns_since(clock_type::time_point start) {
+    return double(std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now() - start).count());
+}
+
+std::vector<int> random_keys(int count) {
+    std::vector<int> keys(count);
+    unsigned int x = 2463534242u; // xorshift state
+    for (auto & key : keys) { x ^= x << 13; x ^= x >> 17; x ^= x << 5; key = int(x >> 1); }
+    return keys;
+}
+
+struct locked_dictionary {
+    dictionary<int, int> dict;
+    mutable std::mutex lock;
+    void insert(int key) {
+        std::lock_guard<std::mutex> guard(lock);
+        dict.insert(pair<int, int>(key, key));
+    }
+    // sum of the values of up to count items from the key
+    long scan(int key, int count) const {
+        std::lock_guard<std::mutex> guard(lock);
+        long sum = 0;
+        for (auto it = dict.lower_bound(key); it != dict.end() && count--; ++it) sum += (*it).second;
+        return sum;
+    }
+};
+
+struct skip_list_map {
+    concurrent_map<int, int> map;
+    void insert(int key) { map.insert(pair<int, int>(key, key)); }
+    long scan(int key, int count) const {
+        long sum = 0;
+        for (auto it = map.lower_bound(key); it != map.end() && count--; ++it) sum += (*it).second;
+        return sum;
+    }
+};
+
+// writers insert their share of the keys, while scanners scan 64 items from random keys,
+// until the writers are done
+template<class container_type>
+void bench(const char * name, int writers, int scanners, const std::vector<int> & keys) {
+    container_type container;
+    std::atomic<bool> done{false};
+    std::atomic<long> scans{0}, sink{0};
+    std::vector<std::thread> threads;
+    auto start = clock_type::now();
+    for (int id = 0; id < writers; ++id)
+        threads.emplace_back([&, id]() {
+            for (size_t ix = id; ix < keys.size(); ix += writers) container.insert(keys[ix]);
+        });
+    for (int id = 0; id < scanners; ++id)
+        threads.emplace_back([&, id]() {
+            long count = 0, sum = 0;
+            for (size_t ix = id; !done.load(std::memory_order_relaxed); ix = (ix + 7919) % keys.size(), ++count)
+                sum += container.scan(keys[ix], 64);
+            scans += count; sink += sum;
+        });
+    for (int id = 0; id < writers; ++id) threads[id].join();
+    const double insert_ns = ns_since(start);
+    done = true;
+    for (int id = writers; id < writers + scanners; ++id) threads[id].join();
+    std::printf("%-18s writers %d scanners %d  n %8zu  insert ns/op %7.1f  scans/ms %8.1f  (%ld)\n", name,
+                writers, scanners, keys.size(), insert_ns / double(keys.size()),
+                double(scans.load()) / (insert_ns / 1e6), sink.load() & 1);
+}
+
+int main() {
+    print_test_header("bench_concurrent_inserts_and_scans");
+    const std::vector<int> keys = random_keys(1<<20);
+    const unsigned cores = std::thread::hardware_concurrency();
+    std::printf("hardware threads %u\n", cores);
+    for (const int writers : { 1, 2, 4, 8 }) {
+        bench<locked_dictionary>("dictionary+mutex", writers, 0, keys);
+        bench<skip_list_map>("concurrent_map", writers, 0, keys);
+        bench<locked_dictionary>("dictionary+mutex", writers, 2, keys);
+        bench<skip_list_map>("concurrent_map", writers, 2, keys);
+    }
+}
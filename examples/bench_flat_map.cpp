@@ -0,0 +1,85 @@
+// benchmark of flat_map and flat_set versus dictionary and ordered_set, lookup and scan
+#include "src/test_utils.h"
+#include <micro-containers/flat_map.h>
+#include <micro-containers/flat_set.h>
+#include <micro-containers/dictionary.h>
+#include <micro-containers/ordered_set.h>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+using namespace microc;
+using clock_type = std::chrono::high_resolution_clock;
+
+double ns_since(clock_type::time_point start) {
+    return double(std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now() - start).count());
+}
+
+std::vector<int> random_keys(int count) {
+    std::vector<int> keys(count);
+    unsigned int x = 2463534242u; // xorshift state
+    for (auto & key : keys) { x ^= x << 13; x ^= x >> 17; x ^= x << 5; key = int(x >> 1); }
+    return keys;
+}
+
+// build from a batch, lookup every key and a miss, then scan the mapped values, in ns per item
+template<class container_type>
+void bench_map(const char * name, const std::vector<pair<int, int>> & items,
+               const std::vector<int> & queries) {
+    container_type container;
+    auto start = clock_type::now();
+    container.insert(items.begin(), items.end());
+    const double build_ns = ns_since(start);
+    long sink = 0;
+    start = clock_type::now();
+    for (const auto key : queries) sink += container.contains(key);
+    const double lookup_ns = ns_since(start);
+    start = clock_type::now();
+    for (const auto key : queries) { auto it = container.find(key); if (it != container.end()) sink += (*it).second; }
+    const double find_ns = ns_since(start);
+    start = clock_type::now();
+    for (const auto & item : container) sink += item.second;
+    const double scan_ns = ns_since(start);
+    const double n = double(items.size());
+    std::printf("%-12s n %8zu  batch build %7.2f  contains %7.2f  find %7.2f  scan %6.2f  (%ld)\n", name,
+                items.size(), build_ns / n, lookup_ns / double(queries.size()),
+                find_ns / double(queries.size()), scan_ns / n, sink);
+}
+
+template<class container_type>
+void bench_set(const char * name, const std::vector<int> & keys, const std::vector<int> & queries) {
+    container_type container;
+    auto start = clock_type::now();
+    container.insert(keys.begin(), keys.end());
+    const double build_ns = ns_since(start);
+    long sink = 0;
+    start = clock_type::now();
+    for (const auto key : queries) sink += container.contains(key);
+    const double lookup_ns = ns_since(start);
+    start = clock_type::now();
+    for (const auto & key : container) sink += key & 1;
+    const double scan_ns = ns_since(start);
+    const double n = double(keys.size());
+    std::printf("%-12s n %8zu  batch build %7.2f  contains %7.2f  scan %6.2f  (%ld)\n", name,
+                keys.size(), build_ns / n, lookup_ns / double(queries.size()), scan_ns / n, sink);
+}
+
+void bench(int count) {
+    const std::vector<int> keys = random_keys(count);
+    // half of the queries hit
+    std::vector<int> queries = random_keys(2 * count);
+    for (int ix = 0; ix < count; ix += 2) queries[ix] = keys[ix];
+    std::vector<pair<int, int>> items;
+    for (const auto key : keys) items.push_back(pair<int, int>(key, key & 0xff));
+    bench_map<dictionary<int, int>>("dictionary", items, queries);
+    bench_map<flat_map<int, int>>("flat_map", items, queries);
+    bench_set<ordered_set<int>>("ordered_set", keys, queries);
+    bench_set<flat_set<int>>("flat_set", keys, queries);
+}
+
+int main() {
+    print_test_header("bench_flat_map, ns per item");
+    bench(1<<10);
+    bench(1<<16);
+    bench(1<<20);
+}
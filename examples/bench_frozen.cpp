@@ -0,0 +1,65 @@
+// benchmark of lookups in frozen layouts versus dictionary and flat_map
+#include "src/test_utils.h"
+#include <micro-containers/frozen_map.h>
+#include <micro-containers/frozen_set.h>
+#include <micro-containers/dictionary.h>
+#include <micro-containers/flat_map.h>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+using namespace microc;
+using clock_type = std::chrono::high_resolution_clock;
+
+double ns_since(clock_type::time_point start) {
+    return double(std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now() - start).count());
+}
+
+std::vector<int> random_keys(int count) {
+    std::vector<int> keys(count);
+    unsigned int x = 2463534242u; // xorshift state
+    for (auto & key : keys) { x ^= x << 13; x ^= x >> 17; x ^= x << 5; key = int(x >> 1); }
+    return keys;
+}
+
+// find and contains of random keys, half of them hit, and a full scan, in ns per item
+template<class container_type>
+void bench(const char * name, const container_type & container, const std::vector<int> & queries) {
+    long sink = 0;
+    auto start = clock_type::now();
+    for (const auto key : queries) {
+        auto it = container.find(key);
+        if (it != container.end()) sink += (*it).second;
+    }
+    const double find_ns = ns_since(start);
+    start = clock_type::now();
+    for (const auto key : queries) sink += container.contains(key);
+    const double contains_ns = ns_since(start);
+    start = clock_type::now();
+    for (const auto & item : container) sink += item.second;
+    const double scan_ns = ns_since(start);
+    const double q = double(queries.size());
+    std::printf("%-22s n %8zu  find %7.2f  contains %7.2f  scan %6.2f  (%ld)\n", name, container.size(),
+                find_ns / q, contains_ns / q, scan_ns / double(container.size()), sink);
+}
+
+void bench(int count) {
+    const std::vector<int> keys = random_keys(count);
+    std::vector<int> queries = random_keys(2 * count);
+    for (int ix = 0; ix < count; ix += 2) queries[ix] = keys[ix];
+    dictionary<int, int> dict;
+    for (const auto key : keys) dict.insert(pair<int, int>(key, key & 0xff));
+    flat_map<int, int> flat;
+    for (const auto & item : dict) flat.insert(item);
+    bench("dictionary", dict, queries);
+    bench("flat_map", flat, queries);
+    bench("frozen eytzinger", freeze(dict), queries);
+    bench("frozen s_tree<16>", freeze<s_tree_layout<16>>(dict), queries);
+}
+
+int main() {
+    print_test_header("bench_frozen, ns per item");
+    bench(1<<10);
+    bench(1<<16);
+    bench(1<<20);
+}
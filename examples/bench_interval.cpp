@@ -0,0 +1,60 @@
+// benchmark of stabbing and overlap queries of interval_map versus a linear scan
+#include "src/test_utils.h"
+#include <micro-containers/interval_map.h>
+#include <micro-containers/dynamic_array.h>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+using namespace microc;
+using clock_type = std::chrono::high_resolution_clock;
+
+double ns_since(clock_type::time_point start) {
+    return double(std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now() - start).count());
+}
+
+struct xorshift {
+    unsigned int x = 2463534242u;
+    unsigned int operator()() { x ^= x << 13; x ^= x >> 17; x ^= x << 5; return x; }
+};
+
+// address ranges, most are short and a few are wide, as routes and allocations are
+void bench(int count, int queries) {
+    xorshift random;
+    dynamic_array<pair<interval<unsigned>, int>> ranges;
+    interval_map<unsigned, int> map;
+    auto start = clock_type::now();
+    for (int ix = 0; ix < count; ++ix) {
+        const unsigned low = random() >> 1, width = random() % 20 == 0 ? random() >> 8 : random() % 4096;
+        ranges.push_back(pair<interval<unsigned>, int>(interval<unsigned>(low, low + width), ix));
+        map.insert(ranges.back());
+    }
+    const double insert_ns = ns_since(start) / double(count);
+    std::vector<unsigned> points(queries);
+    for (auto & point : points) point = random() >> 1;
+
+    long scan_hits = 0, map_hits = 0, overlap_hits = 0;
+    start = clock_type::now();
+    for (const auto point : points)
+        for (const auto & range : ranges)
+            if (range.first.low <= point && point <= range.first.high) scan_hits += range.second;
+    const double scan_ns = ns_since(start) / double(queries);
+    start = clock_type::now();
+    for (const auto point : points)
+        for (const auto & item : map.containing(point)) map_hits += item.second;
+    const double stab_ns = ns_since(start) / double(queries);
+    start = clock_type::now();
+    for (const auto point : points)
+        for (const auto & item : map.overlaps(point, point + 65536)) overlap_hits += item.second;
+    const double overlap_ns = ns_since(start) / double(queries);
+    std::printf("n %7d  insert ns/op %6.1f  linear scan ns/query %10.1f  containing ns/query %7.1f  "
+                "overlaps of 64K ns/query %7.1f  (%ld, %ld, %ld)\n", count, insert_ns, scan_ns, stab_ns,
+                overlap_ns, scan_hits, map_hits, overlap_hits);
+}
+
+int main() {
+    print_test_header("bench_stabbing_queries");
+    bench(1<<10, 1<<14);
+    bench(1<<14, 1<<12);
+    bench(1<<18, 1<<8);
+}
@@ -0,0 +1,138 @@
+// benchmark of the lru pools over synthetic workloads or a replayed key trace.
+// usage:
+//   bench_lru_pools                        - synthetic zipf, scan and loop workloads
+//   bench_lru_pools <trace>                - text trace, one key per line (decimal or 0x hex)
+//   bench_lru_pools <trace> --binary       - binary trace of native endian 64 bit keys
+// keys are mixed before they are handed to the pools, because the pools expect hashed keys.
+#define LRU_CACHE_ENABLE_STATS
+#include "src/test_utils.h"
+#include <micro-containers/bits_robin_lru_pool.h>
+#include <micro-containers/bits_linear_probe_lru_pool.h>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace microc;
+using trace_t = std::vector<unsigned long>;
+constexpr int pool_bits = 12;
+constexpr int trace_length = 1<<20;
+
+unsigned long mix(unsigned long x) {
+    // splitmix64 finalizer
+    x ^= x >> 30; x *= 0xbf58476d1ce4e5b9ul;
+    x ^= x >> 27; x *= 0x94d049bb133111ebul;
+    x ^= x >> 31;
+    return x;
+}
+
+struct xorshift {
+    unsigned long x = 88172645463325252ul;
+    unsigned long operator()() { x ^= x << 13; x ^= x >> 7; x ^= x << 17; return x; }
+    double uniform() { return double((*this)() >> 11) * (1.0 / 9007199254740992.0); }
+};
+
+// keys in [0, keys) with popularity of rank r proportional to 1/(r+1)^s
+trace_t zipf_trace(int length, int keys, double s) {
+    std::vector<double> cdf(keys);
+    double sum = 0;
+    for (int ix = 0; ix < keys; ++ix) cdf[ix] = (sum += 1.0 / std::pow(double(ix + 1), s));
+    for (auto & c : cdf) c /= sum;
+    xorshift rng;
+    trace_t trace(length);
+    for (auto & key : trace) {
+        const double u = rng.uniform();
+        int lo = 0, hi = keys - 1;
+        while (lo < hi) {
+            const int mid = (lo + hi) / 2;
+            if (cdf[mid] < u) lo = mid + 1; else hi = mid;
+        }
+        key = (unsigned long)lo;
+    }
+    return trace;
+}
+
+// every key is seen once
+trace_t scan_trace(int length) {
+    trace_t trace(length);
+    for (int ix = 0; ix < length; ++ix) trace[ix] = (unsigned long)ix;
+    return trace;
+}
+
+// the same keys over and over, in the same order
+trace_t loop_trace(int length, int keys) {
+    trace_t trace(length);
+    for (int ix = 0; ix < length; ++ix) trace[ix] = (unsigned long)(ix % keys);
+    return trace;
+}
+
+bool read_trace(const char * path, bool binary, trace_t & trace) {
+    FILE * file = std::fopen(path, binary ? "rb" : "r");
+    if (!file) return false;
+    if (binary) {
+        unsigned long long buffer[4096];
+        size_t count;
+        while ((count = std::fread(buffer, sizeof(buffer[0]), 4096, file)) > 0)
+            for (size_t ix = 0; ix < count; ++ix) trace.push_back((unsigned long)buffer[ix]);
+    } else {
+        char line[256];
+        while (std::fgets(line, sizeof(line), file)) {
+            char * end;
+            const unsigned long long key = std::strtoull(line, &end, 0);
+            if (end != line) trace.push_back((unsigned long)key);
+        }
+    }
+    std::fclose(file);
+    return true;
+}
+
+template<class pool_type>
+void replay(const char * workload, const char * name, const trace_t & trace, float load_factor) {
+    pool_type pool{load_factor};
+    auto start = std::chrono::high_resolution_clock::now();
+    long sink = 0;
+    for (const auto key : trace)
+        sink += pool.get_or_put(long(key)).value;
+    auto end = std::chrono::high_resolution_clock::now();
+    const double ns = double(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+    const auto stats = pool.stats();
+    std::printf("%-8s %-14s lf %.2f  max size %7d  hit ratio %.4f  ns/op %7.2f  avg probe %6.3f  (%ld)\n",
+                workload, name, load_factor, pool.maxSize(), stats.hit_ratio(),
+                ns / double(trace.size()), stats.average_probe_distance(), sink);
+    std::fflush(stdout);
+}
+
+void run(const char * workload, trace_t trace) {
+    using alloc = microc::std_allocator<char>;
+    using robin_t = bits_robin_lru_pool<pool_bits, long, alloc>;
+    using linear_t = bits_linear_probe_lru_pool<pool_bits, long, alloc>;
+    for (auto & key : trace) key = mix(key);
+    const float load_factors[] = { 0.25f, 0.5f, 0.75f, 0.9f };
+    for (const auto load_factor : load_factors) {
+        replay<robin_t>(workload, "robin hood", trace, load_factor);
+        replay<linear_t>(workload, "linear probe", trace, load_factor);
+    }
+}
+
+int main(int argc, char ** argv) {
+    print_test_header("bench_lru_pools");
+    std::printf("capacity %d, keys are mixed with splitmix64\n", 1<<pool_bits);
+    if (argc > 1) {
+        const bool binary = argc > 2 && std::strcmp(argv[2], "--binary") == 0;
+        trace_t trace;
+        if (!read_trace(argv[1], binary, trace)) {
+            std::printf("could not read %s\n", argv[1]);
+            return 1;
+        }
+        std::printf("trace %s, %zu keys\n", argv[1], trace.size());
+        run("trace", trace);
+        return 0;
+    }
+    run("zipf", zipf_trace(trace_length, 1<<16, 0.99));
+    run("scan", scan_trace(trace_length));
+    // a loop, that fits the higher load factors only
+    run("loop", loop_trace(trace_length, 2500));
+    return 0;
+}
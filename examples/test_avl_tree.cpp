@@ -283,9 +283,85 @@ void test_copy_and_move_assignment() {
     print_simple_container(avl1);
 }
 
+void test_assign_sorted() {
+    print_test_header("test_assign_sorted");
+
+    using avl_t = avl_tree<int>;
+    avl_t avl;
+    avl.insert(1000);
+
+    const int sorted[] = { 50, 100, 150, 250, 350, 450, 550 };
+    const bool built = avl.assign_sorted(sorted, sorted + 7);
+    std::cout << "- tree after assign_sorted (" << built << "): " << std::endl;
+    print_simple_container(avl);
+    std::cout << "- root: " << avl.root()->item << ", height: " << avl.root()->height << std::endl;
+
+    const int unsorted[] = { 50, 40, 60 };
+    std::cout << "- assign_sorted of unsorted: " << avl.assign_sorted(unsorted, unsorted + 3) << std::endl;
+    print_simple_container(avl);
+}
+
+void test_insert_sorted() {
+    print_test_header("test_insert_sorted");
+
+    using avl_t = avl_tree<int>;
+    avl_t avl;
+    const int sorted[] = { 100, 200, 300, 400 };
+    avl.assign_sorted(sorted, sorted + 4);
+
+    const int interleaved[] = { 50, 150, 200, 250, 500 };
+    avl.insert_sorted(interleaved, interleaved + 5);
+    std::cout << "- tree after insert_sorted: " << std::endl;
+    print_simple_container(avl);
+    std::cout << "- size: " << avl.size() << std::endl;
+}
+
+// prints the tree in pre order, as item:height (left right), and counts the nodes, whose
+// height is wrong or whose sub trees differ by more than one in height
+template<class node_type>
+int print_shape(const node_type * node) {
+    if (node == nullptr) { std::cout << "."; return 0; }
+    std::cout << node->item << ":" << node->height;
+    if (node->left == nullptr && node->right == nullptr) return node->height != 0;
+    std::cout << " (";
+    int bad = print_shape(node->left);
+    std::cout << " ";
+    bad += print_shape(node->right);
+    std::cout << ")";
+    const int left = node->left ? node->left->height : -1;
+    const int right = node->right ? node->right->height : -1;
+    const int balance = left - right;
+    return bad + (node->height != (left > right ? left : right) + 1 || balance > 1 || balance < -1);
+}
+
+void test_remove_re_balance() {
+    print_test_header("test_remove_re_balance");
+
+    using avl_t = avl_tree<int>;
+    avl_t avl;
+    // after the removals, 20 is right heavy, and its right child 40 is balanced, which
+    // takes a single rotation, and leaves have height 0
+    const int keys[] = { 20, 10, 40, 5, 30, 50, 25, 35, 45, 55, 60 };
+    for (const auto key : keys) avl.insert(key);
+    std::cout << "- tree after insertion: ";
+    int bad = print_shape(avl.root());
+    std::cout << ", bad nodes " << bad << std::endl;
+    avl.remove(60);
+    avl.remove(5);
+    std::cout << "- tree after removal of 60 and 5: ";
+    bad = print_shape(avl.root());
+    std::cout << ", bad nodes " << bad << std::endl;
+    avl.remove(10);
+    std::cout << "- tree after removal of 10: ";
+    bad = print_shape(avl.root());
+    std::cout << ", bad nodes " << bad << std::endl;
+    std::cout << "- root: " << avl.root()->item << ", height: " << avl.root()->height << std::endl;
+}
+
 int main() {
     test_insert();
     test_remove();
+    test_remove_re_balance();
     test_clear();
     test_find();
     test_max_min();
@@ -295,6 +371,7 @@ int main() {
     test_iterator();
     test_copy_and_move_ctor();
     test_copy_and_move_assignment();
-
+    test_assign_sorted();
+    test_insert_sorted();
 }
 
@@ -0,0 +1,102 @@
+#include "src/test_utils.h"
+#include <micro-containers/b_tree.h>
+#include <micro-containers/dictionary.h>
+#include <micro-containers/ordered_set.h>
+
+using namespace microc;
+
+// small nodes, so a few items already split leaves and grow inner nodes
+using b_tree_t = b_tree<int, int, b_tree_less<int>, b_tree_key_extract<int, int>, std_allocator<char>, 4>;
+
+void test_insert() {
+    print_test_header("test_insert");
+
+    b_tree_t tree;
+    for (int ix = 0; ix < 20; ++ix) tree.insert((ix * 7) % 20 * 10);
+
+    std::cout << "- tree after insertion: " << std::endl;
+    print_simple_container(tree);
+    std::cout << "- size: " << tree.size() << ", height: " << tree.height() << std::endl;
+    std::cout << "- insert existing 50 succeeded: " << tree.insert(50).second << std::endl;
+}
+
+void test_remove() {
+    print_test_header("test_remove");
+
+    b_tree_t tree;
+    for (int ix = 0; ix < 20; ++ix) tree.insert(ix * 10);
+    for (int ix = 0; ix < 20; ix += 3) tree.remove(ix * 10);
+
+    std::cout << "- tree after removal: " << std::endl;
+    print_simple_container(tree);
+    std::cout << "- next of removed 100: " << *tree.remove(100) << std::endl;
+    std::cout << "- size: " << tree.size() << ", height: " << tree.height() << std::endl;
+
+    for (int ix = 0; ix < 20; ++ix) tree.remove(ix * 10);
+    std::cout << "- tree after removing all: " << std::endl;
+    print_simple_container(tree);
+}
+
+void test_find_and_bounds() {
+    print_test_header("test_find_and_bounds");
+
+    b_tree_t tree;
+    for (int ix = 0; ix < 20; ++ix) tree.insert(ix * 10);
+
+    std::cout << "- find 70: " << *tree.find(70) << std::endl;
+    std::cout << "- find 75 is end: " << (tree.find(75) == tree.end()) << std::endl;
+    std::cout << "- lower_bound 75: " << *tree.lower_bound(75) << std::endl;
+    std::cout << "- lower_bound 80: " << *tree.lower_bound(80) << std::endl;
+    std::cout << "- upper_bound 80: " << *tree.upper_bound(80) << std::endl;
+    std::cout << "- upper_bound 190 is end: " << (tree.upper_bound(190) == tree.end()) << std::endl;
+    std::cout << "- minimum: " << *tree.minimum() << ", maximum: " << *tree.maximum() << std::endl;
+}
+
+void test_reverse_iteration() {
+    print_test_header("test_reverse_iteration");
+
+    b_tree_t tree;
+    for (int ix = 0; ix < 20; ++ix) tree.insert(ix);
+
+    std::cout << "(";
+    for (auto it = tree.end(); it != tree.begin();) std::cout << *(--it) << ", ";
+    std::cout << ")" << std::endl;
+}
+
+void test_dummy_items() {
+    print_test_header("test_dummy_items");
+
+    using tree_t = b_tree<dummy_t, dummy_t, b_tree_less<dummy_t>,
+                          b_tree_key_extract<dummy_t, dummy_t>, std_allocator<char>, 4>;
+    tree_t tree;
+    for (int ix = 0; ix < 5; ++ix) tree.insert(dummy_t(ix, ix));
+    print_simple_container(tree);
+}
+
+void test_backends() {
+    print_test_header("test_backends");
+
+    using dict = dictionary<int, int, dict_less<int>, std_allocator<char>, b_tree_backend<4>>;
+    dict d;
+    for (int ix = 0; ix < 10; ++ix) d.insert(pair<int, int>(ix, ix * ix));
+    d.erase(d.find(2), d.find(6));
+    std::cout << "- dictionary: " << std::endl;
+    for (const auto & item : d) std::cout << to_string(item, true) << ", ";
+    std::cout << std::endl;
+
+    using set = ordered_set<int, ordered_set_less<int>, std_allocator<char>, b_tree_backend<>>;
+    set s;
+    for (int ix = 10; ix > 0; --ix) s.insert(ix);
+    s.erase(5);
+    std::cout << "- ordered_set: " << std::endl;
+    print_simple_container(s);
+}
+
+int main() {
+    test_insert();
+    test_remove();
+    test_find_and_bounds();
+    test_reverse_iteration();
+    test_dummy_items();
+    test_backends();
+}
@@ -1,6 +1,12 @@
 #include "src/test_utils.h"
 #include <micro-containers/bits_robin_lru_pool.h>
 #include <micro-containers/bits_linear_probe_lru_pool.h>
+#include <chrono>
+#include <map>
+#include <list>
+#include <vector>
+#include <thread>
+#include <atomic>
 
 
 void test_cache_linear_probe() {
@@ -107,8 +113,189 @@ void test_cache_robin_hood() {
 
 }
 
+void test_random_replay() {
+    print_test_header("test_random_replay");
+    using pool_t = bits_robin_lru_pool<6, long, microc::std_allocator<char>>;
+    pool_t pool{0.5f};
+    // reference of the pool, keys to values, and the keys from most to least recently used
+    std::map<long, int> values;
+    std::list<long> order;
+    const long key_range = 3 * pool.capacity();
+    unsigned long x = 88172645463325252ul; // xorshift state
+    int failures = 0;
+    for (int op = 0; op < 200000 && failures < 10; ++op) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        const long key = long((x >> 8) % key_range);
+        const int kind = int(x % 8);
+        if (kind < 5) {
+            const auto result = pool.get_or_put(key);
+            if (result.removed_value != -1) {
+                values.erase(result.removed_key);
+                order.remove(result.removed_key);
+            }
+            if (result.is_active && values[key] != result.value) ++failures;
+            values[key] = result.value;
+            order.remove(key); order.push_front(key);
+        } else if (kind < 6) {
+            const int value = pool.get(key);
+            if (value != (values.count(key) ? values[key] : -1)) ++failures;
+            if (value != -1) { order.remove(key); order.push_front(key); }
+        } else if (kind < 7) {
+            const int value = pool.remove(key);
+            if (value != (values.count(key) ? values[key] : -1)) ++failures;
+            values.erase(key); order.remove(key);
+        } else {
+            long removed_key = 0;
+            const int value = pool.remove_lru(&removed_key);
+            if (value != -1) { values.erase(removed_key); order.remove(removed_key); }
+        }
+        // size, forward and backward iteration and lookups agree with the reference
+        int forward = 0, backward = 0;
+        auto expected = order.begin();
+        for (auto kv : pool) {
+            if (++forward > pool.capacity()) break;
+            if (expected == order.end() || kv.key != *expected++) ++failures;
+        }
+        for (auto it = pool.lru(); it != pool.end() && backward <= pool.capacity(); --it) ++backward;
+        if (pool.size() != int(values.size()) || forward != pool.size() || backward != pool.size()) ++failures;
+        for (long k = 0; k < key_range; ++k)
+            if (pool.value_of(k) != (values.count(k) ? values[k] : -1)) { ++failures; break; }
+        if (failures) std::cout << "- mismatch at op " << op << std::endl;
+    }
+    std::cout << "- failures " << failures << std::endl;
+}
+
+void test_wide_index() {
+    print_test_header("test_wide_index");
+    using alloc = microc::std_allocator<char>;
+    // a wide pool gives the same results as a packed one, for the same keys
+    bits_robin_lru_pool<20, long, alloc> packed{0.5f};
+    bits_robin_lru_pool<20, long, alloc, true> wide{0.5f};
+    unsigned long x = 88172645463325252ul; // xorshift state
+    int mismatches = 0;
+    for (int ix = 0; ix < 1<<21; ++ix) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        const long key = long(x % (1<<20));
+        const auto a = packed.get_or_put(key);
+        const auto b = wide.get_or_put(key);
+        mismatches += a.value != b.value || a.is_active != b.is_active || a.removed_value != b.removed_value;
+    }
+    int iterated = 0;
+    for (auto kv : wide) mismatches += wide.value_of(kv.key) != kv.value, ++iterated;
+    std::cout << "- capacity " << wide.capacity() << ", size " << wide.size() << ", iterated " << iterated
+              << ", mismatches " << mismatches << std::endl;
+}
+
+void test_deserialize_rejects_corrupt_image() {
+    print_test_header("test_deserialize_rejects_corrupt_image");
+    using pool_t = bits_robin_lru_pool<6, long, microc::std_allocator<char>>;
+    // a run-time capacity of 32, less than 2^6, so links can point past it
+    pool_t pool{5, 0.5f}, restored{0.5f};
+    // fill past the max size, a full pool holds max size + 1 items
+    for (int ix = 0; ix < 100; ++ix) pool.get_or_put(ix);
+    restored.get_or_put(100);
+    std::vector<unsigned char> image(pool.serialized_size());
+    pool.serialize(image.data(), image.size());
+    std::cout << "- size " << pool.size() << ", max size " << pool.maxSize() << std::endl;
+    lru_image::pool_header header;
+    lru_image::copy_bytes(&header, image.data(), sizeof(header));
+    // the data word of the LRU head item, after its key, LSB[ value | prev | next | free ]MSB
+    const unsigned long head_data = lru_image::aligned(sizeof(header)) +
+            pool_t::item_type_size * header.mru_list + sizeof(long);
+    // corrupt the header, or the head item, one at a time
+    const int corruptions = 8;
+    for (int ix = 0; ix < corruptions; ++ix) {
+        std::vector<unsigned char> corrupt(image);
+        lru_image::pool_header bad = header;
+        long data;
+        lru_image::copy_bytes(&data, corrupt.data() + head_data, sizeof(data));
+        if (ix==0) bad.mru_list = bad.capacity;
+        if (ix==1) bad.free_list = -2;
+        if (ix==2) bad.mru_size = bad.max_size + 2;
+        if (ix==3) bad.max_size = bad.capacity + 1;
+        if (ix==4) bad.mru_list = -1;
+        if (ix==5) data = (data & ~(63l<<12)) | (40l<<12); // next is past the capacity
+        if (ix==6) data = (data & ~63l) | 40l; // value is past the capacity
+        if (ix==7) data = (data & ~(63l<<12)) | (long(header.mru_list)<<12); // the ring closes early
+        lru_image::copy_bytes(corrupt.data(), &bad, sizeof(bad));
+        lru_image::copy_bytes(corrupt.data() + head_data, &data, sizeof(data));
+        std::cout << "- corruption " << ix << " read " << restored.deserialize(corrupt.data(), corrupt.size())
+                  << " bytes, size " << restored.size() << ", value of 100 " << restored.value_of(100) << std::endl;
+    }
+    std::cout << "- intact image read " << (restored.deserialize(image.data(), image.size())==image.size())
+              << ", size " << restored.size() << ", capacity " << restored.capacity() << std::endl;
+    int same = 0;
+    for (auto a = pool.begin(), b = restored.begin(); a != pool.end() && b != restored.end(); ++a, ++b)
+        same += (*a).key==(*b).key && (*a).value==(*b).value;
+    std::cout << "- same items in order " << same << std::endl;
+}
+
+void test_batch() {
+    print_test_header("test_batch");
+    using pool_t = bits_robin_lru_pool<20, long, microc::std_allocator<char>>;
+    const int count = 1<<20;
+    std::vector<long> keys(count);
+    unsigned long x = 88172645463325252ul; // xorshift state
+    for (auto & key : keys) { x ^= x << 13; x ^= x >> 7; x ^= x << 17; key = long(x); }
+    pool_t single{0.5f}, batched{0.5f};
+    std::vector<pool_t::result_type> results(count);
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int ix = 0; ix < count; ++ix) results[ix] = single.get_or_put(keys[ix]);
+    auto mid = std::chrono::high_resolution_clock::now();
+    // batches of a render frame
+    std::vector<pool_t::result_type> batch_results(count);
+    for (int ix = 0; ix < count; ix += 4096)
+        batched.get_or_put_batch(keys.data() + ix, 4096, batch_results.data() + ix);
+    auto end = std::chrono::high_resolution_clock::now();
+    int mismatches = 0;
+    for (int ix = 0; ix < count; ++ix)
+        mismatches += results[ix].value != batch_results[ix].value ||
+                      results[ix].is_active != batch_results[ix].is_active;
+    std::cout << "- single ns " << std::chrono::duration_cast<std::chrono::nanoseconds>(mid - start).count()
+              << ", batched ns " << std::chrono::duration_cast<std::chrono::nanoseconds>(end - mid).count()
+              << ", mismatches " << mismatches << std::endl;
+}
+
+void test_concurrent_readers() {
+    print_test_header("test_concurrent_readers");
+    using pool_t = bits_robin_lru_pool<12, long, microc::std_allocator<char>>;
+    pool_t pool{0.5f};
+    // stable keys, that are never removed, and their values
+    const int stable = 256;
+    std::vector<int> values(stable);
+    for (int ix = 0; ix < stable; ++ix) values[ix] = pool.get_or_put(long(ix) * 7919).value;
+    std::atomic<bool> done{false};
+    std::atomic<long> reads{0}, errors{0};
+    auto reader = [&]() {
+        long count = 0, wrong = 0;
+        while(!done.load()) {
+            for (int ix = 0; ix < stable; ++ix, ++count)
+                wrong += pool.value_of_concurrent(long(ix) * 7919) != values[ix];
+        }
+        reads += count; errors += wrong;
+    };
+    std::vector<std::thread> readers;
+    for (int ix = 0; ix < 3; ++ix) readers.emplace_back(reader);
+    // the writer churns random keys, which displaces and back-shifts the stable ones
+    unsigned long x = 88172645463325252ul; // xorshift state
+    for (int ix = 0; ix < 200000; ++ix) {
+        x ^= x << 13; x ^= x >> 7; x ^= x << 17;
+        const long key = long(x | 1ul);
+        pool.get_or_put(key);
+        pool.remove(key);
+    }
+    done = true;
+    for (auto & thread : readers) thread.join();
+    std::cout << "- reads " << reads.load() << ", wrong reads " << errors.load() << std::endl;
+}
+
 using namespace std;
 int main() {
+    test_random_replay();
+    test_concurrent_readers();
+    test_deserialize_rejects_corrupt_image();
+    test_batch();
+    test_wide_index();
 //    test_cache_robin_hood();
     test_cache_linear_probe();
 }
@@ -0,0 +1,85 @@
+#include "src/test_utils.h"
+#include <micro-containers/concurrent_map.h>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace microc;
+
+template<class Container>
+void print_map(const Container & container) {
+    std::cout << "(";
+    for (const auto & item : container) {
+        std::cout << to_string(item, true) << ", ";
+    }
+    std::cout << ")" << std::endl;
+}
+
+void test_insert_and_find() {
+    print_test_header("test_insert_and_find");
+
+    concurrent_map<int, int> map;
+    map.insert(pair<int, int>(300, 3));
+    map.insert(pair<int, int>(100, 1));
+    map.emplace(200, 2);
+    std::cout << "- insert existing keeps the value " << map.insert(pair<int, int>(100, 9)).second
+              << ", at 100 " << map.at(100) << std::endl;
+    print_map(map);
+
+    std::cout << "- find 200 " << to_string(*map.find(200), true)
+              << ", lower_bound 201 " << to_string(*map.lower_bound(201), true) << std::endl;
+}
+
+void test_erase_and_clear() {
+    print_test_header("test_erase_and_clear");
+
+    concurrent_map<int, int> map;
+    for (int ix = 0; ix < 6; ++ix) map.insert(pair<int, int>(ix, ix * ix));
+    map.erase(0);
+    map.erase(3);
+    print_map(map);
+    map.clear();
+    std::cout << "- cleared is empty " << map.empty() << ", size " << map.size() << std::endl;
+}
+
+void test_concurrent_moved_keys() {
+    print_test_header("test_concurrent_moved_keys");
+
+    concurrent_map<std::string, int> map;
+    const int threads = 8, count = 4000;
+    // long keys, that are not in the small string buffer, so a move leaves them empty.
+    // neighbour threads insert the same keys, so inserts race on the same places
+    auto key_of = [](int index) {
+        char key[40];
+        std::snprintf(key, sizeof(key), "key-%08d-with-a-long-suffix", index);
+        return std::string(key);
+    };
+    auto writer = [&](int id) {
+        for (int ix = 0; ix < count; ++ix) {
+            const int index = ix * threads / 2 + id / 2;
+            map.insert(pair<std::string, int>(key_of(index), index));
+        }
+    };
+    std::vector<std::thread> writers;
+    for (int ix = 0; ix < threads; ++ix) writers.emplace_back(writer, ix);
+    for (auto & thread : writers) thread.join();
+
+    int unordered = 0, missing = 0, wrong = 0, scanned = 0;
+    const std::string * previous = nullptr;
+    for (const auto & item : map) {
+        unordered += previous && !(*previous < item.first);
+        wrong += item.first != key_of(item.second);
+        previous = &item.first;
+        ++scanned;
+    }
+    for (int index = 0; index < count * threads / 2; ++index) missing += !map.contains(key_of(index));
+    std::cout << "- size " << map.size() << ", scanned " << scanned << ", unordered " << unordered
+              << ", missing " << missing << ", wrong " << wrong << std::endl;
+}
+
+int main() {
+    test_insert_and_find();
+    test_erase_and_clear();
+    test_concurrent_moved_keys();
+}
@@ -0,0 +1,90 @@
+#include "src/test_utils.h"
+#include <micro-containers/concurrent_set.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+using namespace microc;
+
+void test_insert_erase_and_lookup() {
+    print_test_header("test_insert_erase_and_lookup");
+
+    concurrent_set<int> set;
+    for (int ix = 9; ix >= 0; --ix) set.insert(ix * 10);
+    std::cout << "- insert existing " << set.insert(50).second << ", size " << set.size() << std::endl;
+    print_simple_container(set);
+
+    std::cout << "- erase 50 " << set.erase(50) << ", erase 55 " << set.erase(55) << std::endl;
+    std::cout << "- contains 50 " << set.contains(50) << ", lower_bound 45 " << *set.lower_bound(45)
+              << ", lower_bound 100 is end " << (set.lower_bound(100)==set.end()) << std::endl;
+    print_simple_container(set);
+    std::cout << "- reclaimed " << set.reclaim() << std::endl;
+}
+
+void test_concurrent_writers() {
+    print_test_header("test_concurrent_writers");
+
+    concurrent_set<long> set;
+    const int threads = 4, count = 20000;
+    // every thread inserts its keys, then erases every third of them
+    auto writer = [&](int id) {
+        for (int ix = 0; ix < count; ++ix) set.insert(long(ix) * threads + id);
+        for (int ix = 0; ix < count; ix += 3) set.erase(long(ix) * threads + id);
+    };
+    std::vector<std::thread> writers;
+    for (int ix = 0; ix < threads; ++ix) writers.emplace_back(writer, ix);
+    for (auto & thread : writers) thread.join();
+
+    long previous = -1, unordered = 0, missing = 0, scanned = 0;
+    for (const auto key : set) {
+        unordered += key <= previous;
+        previous = key;
+        ++scanned;
+    }
+    for (long key = 0; key < long(count) * threads; ++key)
+        missing += set.contains(key) != ((key / threads) % 3 != 0);
+    std::cout << "- size " << set.size() << ", scanned " << scanned << ", unordered " << unordered
+              << ", wrong lookups " << missing << std::endl;
+}
+
+void test_scan_while_writing() {
+    print_test_header("test_scan_while_writing");
+
+    concurrent_set<long> set;
+    const int threads = 3, count = 20000;
+    // even keys stay, odd keys are inserted and erased again by the writers
+    for (long key = 0; key < 2 * count; key += 2) set.insert(key);
+    std::atomic<int> running{threads};
+    auto writer = [&](int id) {
+        for (int ix = id; ix < count; ix += threads) {
+            set.insert(2l * ix + 1);
+            set.erase(2l * ix + 1);
+        }
+        --running;
+    };
+    std::vector<std::thread> writers;
+    for (int ix = 0; ix < threads; ++ix) writers.emplace_back(writer, ix);
+    // scans see every key, that stays, in order, whatever the writers do
+    long scans = 0, unordered = 0, missing = 0;
+    do {
+        long previous = -1, expected = 0;
+        for (auto it = set.lower_bound(0); it != set.end(); ++it) {
+            unordered += *it <= previous;
+            previous = *it;
+            if (*it % 2) continue;
+            missing += *it != expected;
+            expected = *it + 2;
+        }
+        missing += expected != 2l * count;
+        ++scans;
+    } while (running.load());
+    for (auto & thread : writers) thread.join();
+    std::cout << "- scans " << (scans > 0) << ", unordered " << unordered << ", missing " << missing
+              << ", size " << set.size() << std::endl;
+}
+
+int main() {
+    test_insert_erase_and_lookup();
+    test_concurrent_writers();
+    test_scan_while_writing();
+}
@@ -86,6 +86,23 @@ void test_insert_with_range() {
     print_dictionary(d_1);
 }
 
+void test_insert_with_hint() {
+    print_test_header("test_insert_with_hint");
+
+    using dict = dictionary<int, int>;
+    dict d;
+    // keys in order, the last inserted item is the hint of the next
+    auto hint = d.end();
+    for (int ix = 0; ix < 5; ++ix)
+        hint = d.insert(hint, pair<int, int>(ix * 100, ix));
+    // a wrong hint still inserts
+    d.insert(d.begin(), pair<int, int>(250, 9));
+    d.emplace_hint(d.end(), 50, 7);
+
+    std::cout << "- printing dictionary" << std::endl;
+    print_dictionary(d);
+}
+
 void test_erase_with_iterator() {
     print_test_header("test_erase_with_iterator");
 
@@ -110,6 +127,21 @@ void test_erase_with_iterator() {
     print_dictionary(d);
 }
 
+void test_erase_range() {
+    print_test_header("test_erase_range");
+
+    using dict = dictionary<int, int>;
+    dict d;
+    for (int ix = 0; ix < 10; ++ix)
+        d.insert(pair<int, int>(ix * 10, ix));
+
+    std::cout << "- erase keys in [15, 55), erased " << d.erase_range(15, 55) << std::endl;
+    print_dictionary(d);
+    d.erase(d.lower_bound(70), d.end());
+    std::cout << "- erase from 70 to the end" << std::endl;
+    print_dictionary(d);
+}
+
 void test_erase_with_key() {
     print_test_header("test_erase_with_key");
 
@@ -215,6 +247,23 @@ void test_contains() {
     std::cout << "- found -5: " << to_string(d.contains(-5)) << std::endl;
 }
 
+void test_bounds() {
+    print_test_header("test_bounds");
+
+    using dict = dictionary<int, int>;
+    dict d;
+    for (int ix = 1; ix <= 5; ++ix)
+        d.insert(pair<int, int>(ix * 100 + 50, ix));
+
+    std::cout << "- lower_bound(250): " << to_string(*d.lower_bound(250), true) << std::endl;
+    std::cout << "- upper_bound(250): " << to_string(*d.upper_bound(250), true) << std::endl;
+    std::cout << "- lower_bound(300): " << to_string(*d.lower_bound(300), true) << std::endl;
+    std::cout << "- upper_bound(550) is end: " << to_string(d.upper_bound(550)==d.end()) << std::endl;
+    auto range = d.equal_range(350);
+    std::cout << "- equal_range(350): " << to_string(*range.first, true)
+              << " to " << to_string(*range.second, true) << std::endl;
+}
+
 // Element Access
 
 void test_at() {
@@ -319,21 +368,44 @@ void test_copy_and_move_assign() {
     print_dictionary(d1);
 }
 
+void test_split_and_union() {
+    print_test_header("test_split_and_union");
+
+    using dict = dictionary<int, int>;
+    dict hour_1, hour_2;
+    for (int ix = 0; ix < 6; ++ix) {
+        hour_1.insert(pair<int, int>(ix, 1));
+        hour_2.insert(pair<int, int>(ix + 3, 2));
+    }
+
+    hour_1.union_with(hour_2);
+    std::cout << "- union, keys in both keep the values of this: " << std::endl;
+    print_dictionary(hour_1);
+
+    dict later = hour_1.split(4);
+    std::cout << "- split at 4: " << std::endl;
+    print_dictionary(hour_1);
+    print_dictionary(later);
+}
+
 int main() {
     // modifiers
     test_insert();
     test_insert_with_perfect_forward();
     test_insert_with_range();
+    test_insert_with_hint();
 
     test_erase_with_iterator();
     test_erase_with_key();
     test_erase_with_range_iterator();
+    test_erase_range();
 
     test_clear();
 //
 //    // lookup
     test_find();
     test_contains();
+    test_bounds();
 //
 //    // Element Access
     test_at();
@@ -342,5 +414,8 @@ int main() {
 //    // move/copy
     test_copy_and_move_ctor();
     test_copy_and_move_assign();
+
+    // split and set operations
+    test_split_and_union();
 }
 
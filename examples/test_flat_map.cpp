@@ -0,0 +1,152 @@
+#include "src/test_utils.h"
+#include <micro-containers/flat_map.h>
+
+using namespace microc;
+
+template<class Container>
+void print_flat_map(const Container & container) {
+    std::cout << "(";
+    for (const auto & item : container) {
+        std::cout << to_string(item, true) << ", ";
+    }
+    std::cout << ")" << std::endl;
+}
+
+void test_insert() {
+    print_test_header("test_insert");
+
+    using map = flat_map<int, int>;
+    map d;
+
+    d.insert(pair<int, int>(250, 250));
+    d.insert(pair<int, int>(50, 50));
+    d.insert(450, 450);
+    d.insert(pair<int, int>(150, 150));
+    d.insert(350, 350);
+    std::cout << "- inserting 50 again, inserted " << d.insert(pair<int, int>(50, 0)).second << std::endl;
+
+    std::cout << "- printing flat map" << std::endl;
+    print_flat_map(d);
+}
+
+void test_insert_with_range() {
+    print_test_header("test_insert_with_range");
+
+    using map = flat_map<int, int>;
+    map d_1, d_2;
+
+    d_1.insert(50, 50);
+    d_1.insert(150, 150);
+    d_1.insert(250, 250);
+    d_1.insert(350, 350);
+    d_1.insert(450, 450);
+
+    d_2.insert(351, 351);
+    d_2.insert(0, 0);
+    d_2.insert(350, -350);
+    d_2.insert(2, 2);
+    d_2.insert(1, 1);
+
+    std::cout << "- printing flat map d1" << std::endl;
+    print_flat_map(d_1);
+    std::cout << "- printing flat map d2" << std::endl;
+    print_flat_map(d_2);
+
+    d_1.insert(d_2.begin(), d_2.end());
+
+    std::cout << "- printing flat map d1 after batch insert, 350 keeps its value" << std::endl;
+    print_flat_map(d_1);
+
+    pair<int, int> unsorted[] = { pair<int, int>(900, 9), pair<int, int>(700, 7),
+                                  pair<int, int>(800, 8), pair<int, int>(700, 7) };
+    d_1.insert(unsorted, unsorted + 4);
+    std::cout << "- printing flat map d1 after appending an unsorted batch" << std::endl;
+    print_flat_map(d_1);
+}
+
+void test_sorted_bulk() {
+    print_test_header("test_sorted_bulk");
+
+    using map = flat_map<int, int>;
+    map d;
+    pair<int, int> evens[] = { pair<int, int>(0, 0), pair<int, int>(2, 2), pair<int, int>(4, 4) };
+    pair<int, int> odds[] = { pair<int, int>(1, 1), pair<int, int>(3, 3), pair<int, int>(5, 5) };
+    pair<int, int> unsorted[] = { pair<int, int>(9, 9), pair<int, int>(8, 8) };
+
+    std::cout << "- assign_sorted evens " << d.assign_sorted(evens, evens + 3) << std::endl;
+    std::cout << "- insert_sorted odds " << d.insert_sorted(odds, odds + 3) << std::endl;
+    std::cout << "- insert_sorted unsorted " << d.insert_sorted(unsorted, unsorted + 2) << std::endl;
+    print_flat_map(d);
+}
+
+void test_erase() {
+    print_test_header("test_erase");
+
+    using map = flat_map<int, int>;
+    map d;
+    for (int ix = 0; ix < 10; ++ix) d.insert(pair<int, int>(ix * 10, ix));
+
+    std::cout << "- erase key 30 " << d.erase(30) << ", erase key 31 " << d.erase(31) << std::endl;
+    auto next = d.erase(d.find(50));
+    std::cout << "- erase iterator of 50, next is " << (*next).first << std::endl;
+    d.erase(d.lower_bound(70), d.end());
+    std::cout << "- erase [70, end)" << std::endl;
+    print_flat_map(d);
+}
+
+void test_lookup() {
+    print_test_header("test_lookup");
+
+    using map = flat_map<int, int>;
+    map d;
+    for (int ix = 0; ix < 10; ++ix) d.insert(pair<int, int>(ix * 10, ix));
+
+    std::cout << "- contains 40 " << d.contains(40) << ", contains 45 " << d.contains(45) << std::endl;
+    std::cout << "- find 40 " << (*d.find(40)).second << ", find 45 is end " << (d.find(45)==d.end()) << std::endl;
+    std::cout << "- lower_bound 45 " << (*d.lower_bound(45)).first
+              << ", upper_bound 50 " << (*d.upper_bound(50)).first << std::endl;
+    std::cout << "- rank 45 " << d.rank(45) << ", nth 3 " << (*d.nth(3)).first
+              << ", count_range [20, 60) " << d.count_range(20, 60) << std::endl;
+    d[40] = 400;
+    d[45] = 450;
+    std::cout << "- at 40 " << d.at(40) << ", at 45 " << d.at(45) << std::endl;
+    long sum = 0;
+    for (const auto & value : d.values()) sum += value;
+    std::cout << "- sum of values " << sum << std::endl;
+}
+
+void test_copy_and_move() {
+    print_test_header("test_copy_and_move");
+
+    using map = flat_map<int, int>;
+    map d_1;
+    for (int ix = 0; ix < 5; ++ix) d_1.insert(pair<int, int>(ix, ix));
+
+    map d_2(d_1);
+    map d_3(microc::traits::move(d_1));
+    std::cout << "- copy equals move " << (d_2==d_3) << ", moved from is empty " << d_1.empty() << std::endl;
+    d_1 = d_3;
+    d_3 = microc::traits::move(d_2);
+    print_flat_map(d_1);
+    print_flat_map(d_3);
+}
+
+void test_dummy() {
+    print_test_header("test_dummy");
+
+    using map = flat_map<int, dummy_t>;
+    map d;
+    d.insert(pair<int, dummy_t>(2, dummy_t(2, 2)));
+    d.insert(pair<int, dummy_t>(1, dummy_t(1, 1)));
+    print_flat_map(d);
+}
+
+int main() {
+    test_insert();
+    test_insert_with_range();
+    test_sorted_bulk();
+    test_erase();
+    test_lookup();
+    test_copy_and_move();
+    test_dummy();
+}
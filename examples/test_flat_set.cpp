@@ -0,0 +1,90 @@
+#include "src/test_utils.h"
+#include <micro-containers/flat_set.h>
+
+using namespace microc;
+
+void test_insert() {
+    print_test_header("test_insert");
+
+    using set = flat_set<int>;
+    set d;
+
+    d.insert(250);
+    d.insert(50);
+    d.insert(450);
+    d.insert(150);
+    d.insert(350);
+    std::cout << "- inserting 50 again, inserted " << d.insert(50).second << std::endl;
+
+    std::cout << "- printing flat set" << std::endl;
+    print_simple_container(d);
+}
+
+void test_insert_with_range() {
+    print_test_header("test_insert_with_range");
+
+    using set = flat_set<int>;
+    set d_1;
+    d_1.insert(50);
+    d_1.insert(150);
+    d_1.insert(250);
+
+    int batch[] = { 300, 0, 150, 2, 300, 1 };
+    d_1.insert(batch, batch + 6);
+    std::cout << "- printing flat set after batch insert" << std::endl;
+    print_simple_container(d_1);
+
+    int tail[] = { 900, 700, 800 };
+    d_1.insert(tail, tail + 3);
+    std::cout << "- printing flat set after appending a batch" << std::endl;
+    print_simple_container(d_1);
+}
+
+void test_erase() {
+    print_test_header("test_erase");
+
+    using set = flat_set<int>;
+    set d;
+    for (int ix = 0; ix < 10; ++ix) d.insert(ix * 10);
+
+    std::cout << "- erase key 30 " << d.erase(30) << ", erase key 31 " << d.erase(31) << std::endl;
+    auto next = d.erase(d.find(50));
+    std::cout << "- erase iterator of 50, next is " << *next << std::endl;
+    d.erase(d.lower_bound(70), d.end());
+    print_simple_container(d);
+}
+
+void test_lookup() {
+    print_test_header("test_lookup");
+
+    using set = flat_set<int>;
+    set d;
+    int sorted[] = { 0, 10, 20, 30, 40, 50 };
+    std::cout << "- assign_sorted " << d.assign_sorted(sorted, sorted + 6) << std::endl;
+    std::cout << "- contains 40 " << d.contains(40) << ", contains 45 " << d.contains(45) << std::endl;
+    std::cout << "- lower_bound 45 " << *d.lower_bound(45) << ", upper_bound 10 " << *d.upper_bound(10) << std::endl;
+    std::cout << "- rank 45 " << d.rank(45) << ", nth 2 " << *d.nth(2)
+              << ", count_range [10, 40) " << d.count_range(10, 40) << std::endl;
+}
+
+void test_copy_and_move() {
+    print_test_header("test_copy_and_move");
+
+    using set = flat_set<int>;
+    set d_1;
+    for (int ix = 0; ix < 5; ++ix) d_1.insert(ix);
+
+    set d_2(d_1);
+    set d_3(microc::traits::move(d_1));
+    std::cout << "- copy equals move " << (d_2==d_3) << ", moved from is empty " << d_1.empty() << std::endl;
+    d_1 = d_3;
+    print_simple_container(d_1);
+}
+
+int main() {
+    test_insert();
+    test_insert_with_range();
+    test_erase();
+    test_lookup();
+    test_copy_and_move();
+}
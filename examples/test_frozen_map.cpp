@@ -0,0 +1,62 @@
+#include "src/test_utils.h"
+#include <micro-containers/frozen_map.h>
+#include <micro-containers/dictionary.h>
+
+using namespace microc;
+
+template<class Container>
+void print_frozen_map(const Container & container) {
+    std::cout << "(";
+    for (const auto & item : container) {
+        std::cout << to_string(item, true) << ", ";
+    }
+    std::cout << ")" << std::endl;
+}
+
+void test_freeze() {
+    print_test_header("test_freeze");
+
+    dictionary<int, int> dict;
+    for (int ix = 0; ix < 10; ++ix) dict.insert(pair<int, int>(ix * 10, ix));
+    auto frozen = freeze(dict);
+
+    std::cout << "- printing frozen map, size " << frozen.size() << std::endl;
+    print_frozen_map(frozen);
+    std::cout << "- at 40 " << frozen.at(40) << ", contains 45 " << frozen.contains(45)
+              << ", find 45 is end " << (frozen.find(45)==frozen.end()) << std::endl;
+    std::cout << "- lower_bound 45 " << (*frozen.lower_bound(45)).first
+              << ", upper_bound 50 " << (*frozen.upper_bound(50)).first << std::endl;
+}
+
+void test_s_tree_layout() {
+    print_test_header("test_s_tree_layout");
+
+    dictionary<int, int> dict;
+    for (int ix = 0; ix < 10; ++ix) dict.insert(pair<int, int>(ix * 10, ix));
+    auto frozen = freeze<s_tree_layout<4>>(dict);
+
+    std::cout << "- printing frozen map, size " << frozen.size() << std::endl;
+    print_frozen_map(frozen);
+    std::cout << "- at 90 " << frozen.at(90) << ", lower_bound 81 " << (*frozen.lower_bound(81)).first
+              << ", upper_bound 90 is end " << (frozen.upper_bound(90)==frozen.end()) << std::endl;
+}
+
+void test_assign_sorted() {
+    print_test_header("test_assign_sorted");
+
+    frozen_map<int, int> frozen;
+    pair<int, int> sorted[] = { pair<int, int>(1, 10), pair<int, int>(2, 20), pair<int, int>(3, 30) };
+    pair<int, int> unsorted[] = { pair<int, int>(2, 20), pair<int, int>(1, 10) };
+    std::cout << "- assign_sorted " << frozen.assign_sorted(sorted, sorted + 3) << std::endl;
+    std::cout << "- assign_sorted unsorted " << frozen.assign_sorted(unsorted, unsorted + 2) << std::endl;
+    print_frozen_map(frozen);
+
+    frozen_map<int, int> copy(frozen), moved(microc::traits::move(copy));
+    std::cout << "- copy then move equals " << (moved==frozen) << ", moved from is empty " << copy.empty() << std::endl;
+}
+
+int main() {
+    test_freeze();
+    test_s_tree_layout();
+    test_assign_sorted();
+}
@@ -0,0 +1,62 @@
+#include "src/test_utils.h"
+#include <micro-containers/frozen_set.h>
+#include <micro-containers/ordered_set.h>
+
+using namespace microc;
+
+template<class Set>
+void print_lookups(const Set & set) {
+    std::cout << "- contains 40 " << set.contains(40) << ", contains 45 " << set.contains(45) << std::endl;
+    std::cout << "- lower_bound 45 " << *set.lower_bound(45) << ", upper_bound 50 " << *set.upper_bound(50)
+              << ", lower_bound 1000 is end " << (set.lower_bound(1000)==set.end()) << std::endl;
+    std::cout << "- backwards from end: ";
+    for (auto it = set.end(); it != set.begin();) { --it; std::cout << *it << ", "; }
+    std::cout << std::endl;
+}
+
+void test_freeze() {
+    print_test_header("test_freeze");
+
+    ordered_set<int> set;
+    for (int ix = 9; ix >= 0; --ix) set.insert(ix * 10);
+    auto frozen = freeze(set);
+
+    std::cout << "- printing frozen set, size " << frozen.size() << std::endl;
+    print_simple_container(frozen);
+    print_lookups(frozen);
+}
+
+void test_s_tree_layout() {
+    print_test_header("test_s_tree_layout");
+
+    ordered_set<int> set;
+    for (int ix = 0; ix < 10; ++ix) set.insert(ix * 10);
+    // blocks of 4 keys, so the keys spread over 3 blocks and 2 levels
+    auto frozen = freeze<s_tree_layout<4>>(set);
+
+    std::cout << "- printing frozen set, size " << frozen.size() << std::endl;
+    print_simple_container(frozen);
+    print_lookups(frozen);
+}
+
+void test_assign_sorted() {
+    print_test_header("test_assign_sorted");
+
+    frozen_set<int> frozen;
+    int sorted[] = { 1, 2, 3, 5, 8, 13 };
+    int unsorted[] = { 1, 3, 2 };
+    std::cout << "- assign_sorted " << frozen.assign_sorted(sorted, sorted + 6) << std::endl;
+    std::cout << "- assign_sorted unsorted " << frozen.assign_sorted(unsorted, unsorted + 3) << std::endl;
+    print_simple_container(frozen);
+
+    frozen_set<int> copy(frozen), moved(microc::traits::move(copy));
+    std::cout << "- copy then move equals " << (moved==frozen) << ", moved from is empty " << copy.empty() << std::endl;
+    frozen.clear();
+    std::cout << "- cleared is empty " << frozen.empty() << ", begin is end " << (frozen.begin()==frozen.end()) << std::endl;
+}
+
+int main() {
+    test_freeze();
+    test_s_tree_layout();
+    test_assign_sorted();
+}
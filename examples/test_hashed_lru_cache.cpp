@@ -0,0 +1,62 @@
+#include "src/test_utils.h"
+#include <micro-containers/hashed_lru_cache.h>
+#include <string>
+#include <functional>
+
+struct string_hash {
+    microc::size_t operator()(const std::string & s) const { return std::hash<std::string>()(s); }
+};
+// a terrible hash, that collides on every string with the same length
+struct length_hash {
+    microc::size_t operator()(const std::string & s) const { return s.size(); }
+};
+
+void test_put_get() {
+    print_test_header("test_put_get");
+    hashed_lru_cache<std::string, int, 4, string_hash> cache{0.5f};
+    cache.put("apple", 1);
+    cache.put("banana", 2);
+    cache.put("cherry", 3);
+    cache.put("banana", 22);
+
+    std::cout << "- apple: " << *cache.get("apple") << std::endl;
+    std::cout << "- banana: " << *cache.get("banana") << std::endl;
+    std::cout << "- has cherry: " << cache.has("cherry") << std::endl;
+    std::cout << "- has durian: " << cache.has("durian") << std::endl;
+    std::cout << "- remove cherry: " << cache.remove("cherry") << std::endl;
+    std::cout << "- has cherry: " << cache.has("cherry") << std::endl;
+
+    for (auto kv : cache)
+        std::cout << "{ k: " << kv.key << ", v: " << kv.value << " },\n";
+}
+
+void test_collisions() {
+    print_test_header("test_collisions");
+    hashed_lru_cache<std::string, int, 4, length_hash> cache{0.5f};
+    cache.put("abc", 1);
+    // same fingerprint, different key, takes over the entry
+    cache.put("xyz", 2);
+
+    std::cout << "- size: " << cache.size() << std::endl;
+    std::cout << "- get abc is null: " << (cache.get("abc")==nullptr) << std::endl;
+    std::cout << "- get xyz: " << *cache.get("xyz") << std::endl;
+    std::cout << "- remove abc: " << cache.remove("abc") << std::endl;
+    std::cout << "- has xyz: " << cache.has("xyz") << std::endl;
+}
+
+void test_eviction() {
+    print_test_header("test_eviction");
+    hashed_lru_cache<std::string, dummy_t, 4, string_hash> cache{0.5f};
+    for (int ix = 0; ix < 12; ++ix)
+        cache.put(std::to_string(ix), dummy_t{ix, ix});
+
+    std::cout << "- size: " << cache.size() << ", max size: " << cache.maxSize() << std::endl;
+    for (auto kv : cache)
+        std::cout << "{ k: " << kv.key << ", v: " << to_string(kv.value) << " },\n";
+}
+
+int main() {
+    test_put_get();
+    test_collisions();
+    test_eviction();
+}
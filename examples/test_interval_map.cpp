@@ -0,0 +1,48 @@
+#include "src/test_utils.h"
+#include <micro-containers/interval_map.h>
+
+using namespace microc;
+
+template<class Range>
+void print_interval_map(const Range & range) {
+    std::cout << "(";
+    for (const auto & item : range)
+        std::cout << "[" << item.first.low << ", " << item.first.high << "]: " << item.second << ", ";
+    std::cout << ")" << std::endl;
+}
+
+void test_address_ranges() {
+    print_test_header("test_address_ranges");
+
+    // owners of address ranges, the ranges nest
+    interval_map<unsigned, int> owners;
+    owners.insert(0x0A000000u, 0x0AFFFFFFu, 1);
+    owners.insert(0x0A010000u, 0x0A01FFFFu, 2);
+    owners.insert(0x0A010100u, 0x0A0101FFu, 3);
+    owners.insert(0xC0A80000u, 0xC0A8FFFFu, 4);
+    std::cout << "- printing interval map, size " << owners.size() << std::endl;
+    print_interval_map(owners);
+
+    std::cout << "- owners of 10.1.1.7" << std::endl;
+    print_interval_map(owners.containing(0x0A010107u));
+    std::cout << "- owners of 10.2.0.0" << std::endl;
+    print_interval_map(owners.containing(0x0A020000u));
+    std::cout << "- at the range of owner 4 " << owners.at(interval<unsigned>(0xC0A80000u, 0xC0A8FFFFu)) << std::endl;
+}
+
+void test_update_overlaps() {
+    print_test_header("test_update_overlaps");
+
+    // time windows to counts, count the windows, that overlap [25, 35]
+    interval_map<int, int> windows;
+    for (int ix = 0; ix < 6; ++ix)
+        windows.insert(ix * 10, ix * 10 + 9, 0);
+    for (auto & item : windows.overlaps(25, 35)) item.second += 1;
+    windows.erase(interval<int>(0, 9));
+    print_interval_map(windows);
+}
+
+int main() {
+    test_address_ranges();
+    test_update_overlaps();
+}
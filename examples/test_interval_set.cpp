@@ -0,0 +1,53 @@
+#include "src/test_utils.h"
+#include <micro-containers/interval_set.h>
+
+using namespace microc;
+
+template<class Range>
+void print_intervals(const Range & range) {
+    std::cout << "(";
+    for (const auto & value : range)
+        std::cout << "[" << value.low << ", " << value.high << "], ";
+    std::cout << ")" << std::endl;
+}
+
+void test_insert_and_erase() {
+    print_test_header("test_insert_and_erase");
+
+    interval_set<int> set;
+    set.insert(10, 20);
+    set.insert(5, 8);
+    set.insert(10, 15);
+    set.insert(30, 40);
+    std::cout << "- insert existing " << set.insert(5, 8).second
+              << ", insert high before low " << set.insert(9, 1).second << std::endl;
+    std::cout << "- printing interval set, size " << set.size() << std::endl;
+    print_intervals(set);
+
+    set.erase(interval<int>(10, 15));
+    set.erase(set.find(interval<int>(5, 8)));
+    std::cout << "- after erase, contains [10, 20] " << set.contains(interval<int>(10, 20)) << std::endl;
+    print_intervals(set);
+}
+
+void test_stabbing_and_overlaps() {
+    print_test_header("test_stabbing_and_overlaps");
+
+    interval_set<int> set;
+    for (int ix = 0; ix < 8; ++ix)
+        set.insert(ix * 10, ix * 10 + 15);
+    set.insert(0, 100);
+
+    std::cout << "- containing 42" << std::endl;
+    print_intervals(set.containing(42));
+    std::cout << "- overlaps [56, 61]" << std::endl;
+    print_intervals(set.overlaps(56, 61));
+    std::cout << "- containing 200 is empty " << set.containing(200).empty() << std::endl;
+    auto first = set.find_overlap(33, 34);
+    std::cout << "- first overlap of [33, 34] [" << (*first).low << ", " << (*first).high << "]" << std::endl;
+}
+
+int main() {
+    test_insert_and_erase();
+    test_stabbing_and_overlaps();
+}
@@ -1,5 +1,7 @@
+#define LRU_CACHE_ENABLE_STATS
 #include "src/test_utils.h"
 #include <micro-containers/lru_cache.h>
+#include <vector>
 
 void test_cache_robin_hood() {
     int bb = sizeof (long);
@@ -40,9 +42,188 @@ void test_iterator() {
     }
 }
 
+void test_runtime_capacity_and_resize() {
+    print_test_header("test_runtime_capacity_and_resize");
+    // upto 2^10 entries, but start with 2^3
+    lru_cache<int, 10, unsigned int, microc::std_allocator<char>> cache{3, 0.5f};
+    for (int ix = 0; ix < 6; ++ix) cache.put(ix, ix*10);
+    std::cout << "- capacity " << cache.capacity() << ", size " << cache.size() << std::endl;
+    for (auto kv : cache) std::cout << "{ k: " << kv.key << ", v: " << kv.value << " },\n";
+
+    cache.resize(6);
+    std::cout << "- grow, capacity " << cache.capacity() << ", size " << cache.size() << std::endl;
+    for (int ix = 6; ix < 20; ++ix) cache.put(ix, ix*10);
+    cache.get(6);
+    for (auto kv : cache) std::cout << "{ k: " << kv.key << ", v: " << kv.value << " },\n";
+
+    cache.resize(2);
+    std::cout << "- shrink, capacity " << cache.capacity() << ", size " << cache.size() << std::endl;
+    for (auto kv : cache) std::cout << "{ k: " << kv.key << ", v: " << kv.value << " },\n";
+}
+
+void test_weighted() {
+    print_test_header("test_weighted");
+    lru_cache<int, 6, unsigned int, microc::std_allocator<char>, false, true> cache{0.5f};
+    cache.set_max_weight(1000);
+    cache.put(1, 10, 400);
+    cache.put(2, 20, 400);
+    cache.put(3, 30, 100);
+    std::cout << "- weight " << cache.weight() << ", size " << cache.size()
+              << ", evictions " << cache.evictions() << std::endl;
+    // touch 1, so 2 becomes the LRU and is evicted by the next heavy put
+    cache.get(1);
+    cache.put(4, 40, 300);
+    std::cout << "- weight " << cache.weight() << ", size " << cache.size()
+              << ", evictions " << cache.evictions() << std::endl;
+    for (auto kv : cache) std::cout << "{ k: " << kv.key << ", v: " << kv.value << " },\n";
+    // re-weigh an existing entry
+    cache.put(3, 33, 50);
+    cache.remove(4);
+    std::cout << "- weight " << cache.weight() << ", size " << cache.size() << std::endl;
+    // shrink the budget
+    cache.set_max_weight(100);
+    std::cout << "- weight " << cache.weight() << ", size " << cache.size()
+              << ", evictions " << cache.evictions() << std::endl;
+    for (auto kv : cache) std::cout << "{ k: " << kv.key << ", v: " << kv.value << " },\n";
+}
+
+void test_ttl() {
+    print_test_header("test_ttl");
+    using cache_t = lru_cache<int, 6, unsigned int, microc::std_allocator<char>, false, false, true>;
+    cache_t cache{0.5f};
+    cache.put(0, 0); // never expires
+    for (int ix = 1; ix < 10; ++ix)
+        cache.put_with_ttl(ix, ix*10, ix*100, 0);
+    std::cout << "- size " << cache.size() << std::endl;
+    // lazy expiry on access
+    std::cout << "- get 1 at t=150 is null: " << (cache.get(1, 150)==nullptr) << std::endl;
+    std::cout << "- has 2 at t=150: " << cache.has(2) << std::endl;
+    std::cout << "- size " << cache.size() << ", expirations " << cache.expirations() << std::endl;
+    // incremental sweep, with a small budget
+    cache.set_time_resolution(10);
+    int sweeps = 0;
+    for (; sweeps < 1000 && cache.size() > 5; ++sweeps)
+        cache.expire_some(550, 4);
+    std::cout << "- after sweeping to t=550 in " << sweeps << " sweeps, size " << cache.size()
+              << ", expirations " << cache.expirations() << std::endl;
+    for (auto kv : cache) std::cout << "{ k: " << kv.key << ", v: " << kv.value << " },\n";
+    // re-put with a new ttl, and a long jump in time
+    cache.put_with_ttl(9, 99, 10000, 600);
+    cache.expire_some(5000, 1000);
+    std::cout << "- at t=5000, size " << cache.size() << std::endl;
+    for (auto kv : cache) std::cout << "{ k: " << kv.key << ", v: " << kv.value << " },\n";
+    cache.resize(3);
+    cache.expire_some(20000, 1000);
+    std::cout << "- after resize and t=20000, size " << cache.size() << std::endl;
+    for (auto kv : cache) std::cout << "{ k: " << kv.key << ", v: " << kv.value << " },\n";
+}
+
+void test_eviction_listener() {
+    print_test_header("test_eviction_listener");
+    using buffer_t = lru_eviction_buffer<unsigned int, int>;
+    using cache_t = lru_cache<int, 3, unsigned int, microc::std_allocator<char>,
+                              false, false, false, buffer_t>;
+    cache_t cache{0.5f};
+    for (int ix = 0; ix < 8; ++ix) cache.put(ix, ix*10);
+    std::cout << "- size " << cache.size() << ", evictions " << cache.evictions() << std::endl;
+    // write-back the evicted entries
+    auto count = cache.eviction_listener().drain([](unsigned int key, int & value) {
+        std::cout << "{ evicted k: " << key << ", v: " << value << " },\n";
+    });
+    std::cout << "- drained " << count << ", left " << cache.eviction_listener().size() << std::endl;
+    cache.put(8, 80);
+    cache.eviction_listener().drain([](unsigned int key, int & value) {
+        std::cout << "{ evicted k: " << key << ", v: " << value << " },\n";
+    });
+}
+
+void test_resize_evicts_through_listener() {
+    print_test_header("test_resize_evicts_through_listener");
+    using buffer_t = lru_eviction_buffer<unsigned int, int>;
+    using cache_t = lru_cache<int, 6, unsigned int, microc::std_allocator<char>,
+                              false, false, false, buffer_t>;
+    cache_t cache{0.5f};
+    for (int ix = 0; ix < 32; ++ix) cache.put(ix, ix*10);
+    cache.resize(3);
+    // every entry is either kept or handed to the listener, once
+    std::vector<int> seen(32, 0);
+    for (auto kv : cache) ++seen[kv.key];
+    auto count = cache.eviction_listener().drain([&](unsigned int key, int & value) {
+        seen[key] += value == int(key)*10 ? 1 : 100;
+    });
+    int wrong = 0;
+    for (auto times : seen) wrong += times != 1;
+    std::cout << "- size " << cache.size() << ", drained " << count << ", evictions " << cache.evictions()
+              << ", stats evictions " << cache.stats().evictions << ", wrong " << wrong << std::endl;
+}
+
+void print_stats(const lru_stats & stats) {
+    std::cout << "- hits " << stats.hits << ", misses " << stats.misses
+              << ", inserts " << stats.inserts << ", evictions " << stats.evictions
+              << ", removals " << stats.removals << ", hit ratio " << stats.hit_ratio()
+              << ", avg probe distance " << stats.average_probe_distance() << std::endl;
+}
+
+void test_stats() {
+    print_test_header("test_stats");
+    lru_cache<int, 4, unsigned int, microc::std_allocator<char>> cache{0.5f};
+    for (int ix = 0; ix < 12; ++ix) cache.put(ix, ix*10);
+    for (int ix = 0; ix < 12; ++ix) cache.get(ix);
+    cache.remove(11);
+    print_stats(cache.stats());
+    cache.reset_stats();
+    print_stats(cache.stats());
+
+    bits_linear_probe_lru_pool<4, unsigned int, microc::std_allocator<char>> pool{0.5f};
+    for (int ix = 0; ix < 12; ++ix) pool.get_or_put(ix);
+    for (int ix = 0; ix < 12; ++ix) pool.get(ix);
+    print_stats(pool.stats());
+}
+
+void test_serialize() {
+    print_test_header("test_serialize");
+    using cache_t = lru_cache<int, 6, unsigned int, microc::std_allocator<char>, false, true>;
+    cache_t cache{0.5f};
+    cache.set_max_weight(100);
+    for (int ix = 0; ix < 10; ++ix) cache.put(ix, ix*10, ix+1);
+    cache.get(3); cache.get(1);
+    std::vector<unsigned char> image(cache.serialized_size());
+    auto written = cache.serialize(image.data(), image.size());
+    std::cout << "- wrote " << written << " bytes" << std::endl;
+    // restore into a cache with a different run-time capacity, the image capacity is adopted
+    cache_t restored{3, 0.5f};
+    restored.set_max_weight(100);
+    auto read = restored.deserialize(image.data(), image.size());
+    std::cout << "- read " << read << " bytes, capacity " << restored.capacity()
+              << ", size " << restored.size() << ", weight " << restored.weight() << std::endl;
+    for (auto kv : restored) std::cout << "{ k: " << kv.key << ", v: " << kv.value << " },\n";
+    // a truncated image is rejected
+    std::cout << "- truncated image read " << restored.deserialize(image.data(), image.size()/2)
+              << " bytes, size " << restored.size() << std::endl;
+    // a full cache, filled past its max size, holds max size + 1 entries and restores too
+    lru_cache<int, 6, unsigned int, microc::std_allocator<char>> full{0.5f}, warm{0.5f};
+    for (int ix = 0; ix < 100; ++ix) full.put(ix, ix*10);
+    std::vector<unsigned char> full_image(full.serialized_size());
+    written = full.serialize(full_image.data(), full_image.size());
+    read = warm.deserialize(full_image.data(), full_image.size());
+    int same = 0;
+    for (auto a = full.begin(), b = warm.begin(); a != full.end() && b != warm.end(); ++a, ++b)
+        same += (*a).key==(*b).key && (*a).value==(*b).value;
+    std::cout << "- full cache size " << full.size() << ", max size " << full.maxSize()
+              << ", wrote " << written << ", read " << read << ", restored size " << warm.size()
+              << ", same entries in order " << same << std::endl;
+}
+
 using namespace std;
 int main() {
 //    test_cache_robin_hood();
     test_iterator();
+    test_runtime_capacity_and_resize();
+    test_weighted();
+    test_ttl();
+    test_eviction_listener();
+    test_resize_evicts_through_listener();
+    test_stats();
+    test_serialize();
 }
 
@@ -20,7 +20,54 @@ void test_iterator() {
     pool.print();
 }
 
+struct print_listener {
+    void operator()(unsigned int key, dummy_t & object) const {
+        std::cout << "- recycling k: " << key << ", v: " << to_string(object) << std::endl;
+    }
+};
+
+void test_eviction_listener() {
+    print_test_header("test_eviction_listener");
+    lru_pool<dummy_t, 3, unsigned int, microc::std_allocator<char>, false, print_listener> pool(0.5f);
+    pool.construct(0, 0);
+    for (int ix = 0; ix < 7; ++ix) {
+        auto res = pool.get(ix);
+        if(!res.is_active) res.object = dummy_t{ix, ix};
+    }
+}
+
+void test_get_batch() {
+    print_test_header("test_get_batch");
+    lru_pool<dummy_t, 4, unsigned int, microc::std_allocator<char>> pool(0.5f);
+    pool.construct(0, 0);
+    const unsigned int keys[] = { 1, 2, 3, 2, 1, 7 };
+    dummy_t * objects[6];
+    bool is_active[6];
+    pool.get_batch(keys, 6, objects, is_active);
+    for (int ix = 0; ix < 6; ++ix) {
+        if(!is_active[ix]) *objects[ix] = dummy_t{int(keys[ix]), int(keys[ix])};
+        std::cout << "- k: " << keys[ix] << ", active " << is_active[ix]
+                  << ", v: " << to_string(*objects[ix]) << std::endl;
+    }
+}
+
+void test_lazy_construction() {
+    print_test_header("test_lazy_construction");
+    lru_pool<dummy_t, 10, unsigned int, microc::std_allocator<char>> pool(0.5f);
+    pool.construct_lazily(0, 0);
+    std::cout << "- capacity " << pool.capacity() << ", constructed " << pool.constructedCount() << std::endl;
+    for (int ix = 0; ix < 4; ++ix) {
+        auto res = pool.get(ix % 3);
+        if(!res.is_active) res.object = dummy_t{ix, ix};
+    }
+    std::cout << "- size " << pool.size() << ", constructed " << pool.constructedCount() << std::endl;
+    for (auto kv : pool) std::cout << "{ k: " << kv.key << ", v: " << to_string(kv.value) << " },\n";
+}
+
 int main() {
     test_iterator();
+    test_eviction_listener();
+    test_get_batch();
+    test_lazy_construction();
 }
 
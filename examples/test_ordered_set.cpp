@@ -19,6 +19,23 @@ void test_insert() {
     print_simple_container(d);
 }
 
+void test_insert_with_hint() {
+    print_test_header("test_insert_with_hint");
+
+    using set = ordered_set<int>;
+    set d;
+    // keys in order, the last inserted item is the hint of the next
+    auto hint = d.end();
+    for (int ix = 0; ix < 5; ++ix)
+        hint = d.insert(hint, ix * 100);
+    // a wrong hint still inserts
+    d.insert(d.begin(), 250);
+    d.emplace_hint(d.end(), 50);
+
+    std::cout << "- printing ordered set" << std::endl;
+    print_simple_container(d);
+}
+
 void test_insert_with_range() {
     print_test_header("test_insert_with_range");
 
@@ -116,6 +133,21 @@ void test_erase_with_range_iterator() {
     print_simple_container(d);
 }
 
+void test_erase_range() {
+    print_test_header("test_erase_range");
+
+    using set = ordered_set<int>;
+    set d;
+    for (int ix = 0; ix < 10; ++ix)
+        d.insert(ix * 10);
+
+    std::cout << "- erase keys in [15, 55), erased " << d.erase_range(15, 55) << std::endl;
+    print_simple_container(d);
+    d.erase(d.lower_bound(70), d.end());
+    std::cout << "- erase from 70 to the end" << std::endl;
+    print_simple_container(d);
+}
+
 void test_clear() {
     print_test_header("test_clear");
 
@@ -176,6 +208,22 @@ void test_contains() {
     std::cout << "- found -5: " << to_string(d.contains(-5)) << std::endl;
 }
 
+void test_bounds() {
+    print_test_header("test_bounds");
+
+    using set = ordered_set<int>;
+    set d;
+    for (int ix = 1; ix <= 5; ++ix)
+        d.insert(ix * 100 + 50);
+
+    std::cout << "- lower_bound(250): " << *d.lower_bound(250) << std::endl;
+    std::cout << "- upper_bound(250): " << *d.upper_bound(250) << std::endl;
+    std::cout << "- lower_bound(300): " << *d.lower_bound(300) << std::endl;
+    std::cout << "- upper_bound(550) is end: " << to_string(d.upper_bound(550)==d.end()) << std::endl;
+    auto range = d.equal_range(350);
+    std::cout << "- equal_range(350): " << *range.first << " to " << *range.second << std::endl;
+}
+
 // move/copy
 void test_copy_and_move_ctor() {
     print_test_header("test_copy_and_move_ctor");
@@ -250,24 +298,82 @@ void test_dummy() {
     print_simple_container(d1);
 }
 
+void test_order_statistics() {
+    print_test_header("test_order_statistics");
+
+    using set = ordered_set<int, ordered_set_less<int>, std_allocator<char>, avl_order_statistics_backend>;
+    set latencies;
+    for (int ix = 100; ix > 0; --ix) latencies.insert(ix * 10);
+
+    std::cout << "- rank of 255: " << latencies.rank(255) << std::endl;
+    std::cout << "- nth(0): " << *latencies.nth(0) << std::endl;
+    std::cout << "- p50: " << *latencies.nth(latencies.size() * 50 / 100) << std::endl;
+    std::cout << "- p99: " << *latencies.nth(latencies.size() * 99 / 100) << std::endl;
+    std::cout << "- nth(size) is end: " << (latencies.nth(latencies.size()) == latencies.end()) << std::endl;
+    std::cout << "- count in [100, 200): " << latencies.count_range(100, 200) << std::endl;
+    latencies.erase(150);
+    std::cout << "- count in [100, 200) after erase of 150: " << latencies.count_range(100, 200) << std::endl;
+}
+
+void test_set_operations() {
+    print_test_header("test_set_operations");
+
+    using set = ordered_set<int>;
+    set a, b, c, d;
+    for (int ix = 0; ix < 10; ++ix) { a.insert(ix); b.insert(ix + 5); }
+    c = a; d = a;
+
+    a.union_with(b);
+    std::cout << "- union: " << std::endl;
+    print_simple_container(a);
+    std::cout << "- other after union: " << std::endl;
+    print_simple_container(b);
+
+    set e;
+    for (int ix = 5; ix < 15; ++ix) e.insert(ix);
+    c.intersect_with(e);
+    std::cout << "- intersection: " << std::endl;
+    print_simple_container(c);
+    d.difference_with(e);
+    std::cout << "- difference: " << std::endl;
+    print_simple_container(d);
+
+    set right = a.split(7);
+    std::cout << "- split at 7: " << std::endl;
+    print_simple_container(a);
+    print_simple_container(right);
+    a.join(right);
+    std::cout << "- joined back: " << std::endl;
+    print_simple_container(a);
+}
+
 int main() {
     // modifiers
     test_insert();
     test_insert_with_range();
+    test_insert_with_hint();
 
     test_erase_with_iterator();
     test_erase_with_key();
     test_erase_with_range_iterator();
+    test_erase_range();
 
     test_clear();
 
     // lookup
     test_find();
     test_contains();
+    test_bounds();
 
     // move/copy
     test_copy_and_move_ctor();
     test_copy_and_move_assign();
     test_dummy();
+
+    // order statistics
+    test_order_statistics();
+
+    // set operations
+    test_set_operations();
 }
 
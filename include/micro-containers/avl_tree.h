@@ -31,10 +31,43 @@ namespace microc {
         const Key & operator()(const Item &whole) const { return whole; }
     };
 
+    /**
+     * Augmentations keep data in every node, that is computed from the node item and the data of
+     * its children, for example sub tree sizes. A node inherits `node_data`, and `update(node)` is
+     * called bottom up on every node, whose children changed. Augmenting trees update the whole
+     * path to the root after insert and remove, not just until heights stop changing.
+     */
+    struct avl_no_augmentation {
+        static constexpr bool is_augmenting = false;
+        static constexpr bool keeps_sizes = false;
+        struct node_data {};
+        template<class node_t>
+        static void update(node_t *) {}
+    };
+
+    /**
+     * Order statistics augmentation, keeps the size of every sub tree, so rank, select and
+     * count_range of avl_tree run in logarithmic time
+     */
+    struct avl_order_statistics {
+        static constexpr bool is_augmenting = true;
+        static constexpr bool keeps_sizes = true;
+        struct node_data { microc::size_t size; };
+        template<class node_t>
+        static microc::size_t size_of(const node_t *node) { return node ? node->size : 0; }
+        template<class node_t>
+        static void update(node_t *node) { node->size = 1 + size_of(node->left) + size_of(node->right); }
+    };
+
     /**
      * AVL Tree balanced tree, logarithmic complexity everything.
      * Notes:
-     * - Most algorithms use recursion, so there is a stack memory cost of O(log(n))
+     * - insert and remove are iterative, they record the path from the root in a fixed-size
+     *   stack array, that is bounded by the max height of an AVL tree with size_type nodes
+     * - Nodes have parent pointers, so iterating is amortized O(1) without key comparisons,
+     *   and clear (also used by the destructor and move assignment) is linear without a stack
+     * - split, join and the set operations relink nodes with AVL join, set operations of trees
+     *   of sizes m <= n run in O(m*log(n/m+1)), they recurse as deep as the height of a tree
      * - This class is Allocator-Aware
      * - We give user an option to break down and define what is a key, as usually the stored item is the key itself,
      *   BUT, many data structure only use a key which is a partial data of the stored item such as pairs of (key, value).
@@ -47,12 +80,14 @@ namespace microc {
      * @tparam Compare compare structure to compare keys less than binary relation (key_1 < key_2)
      * @tparam KeyExtractFunction (Optional) Extract a key from the stored item object, by default the StoreItemType is the key
      * @tparam Allocator allocator type
+     * @tparam Augmentation node augmentation policy, avl_no_augmentation or avl_order_statistics
      */
     template<class StoreItemType,
              class Key=StoreItemType,
              class Compare=avl_less<Key>,
              class KeyExtractFunction=avl_key_extract<StoreItemType, Key>,
-             class Allocator=microc::std_allocator<char>>
+             class Allocator=microc::std_allocator<char>,
+             class Augmentation=avl_no_augmentation>
     class avl_tree {
     public:
         using store_item_type = StoreItemType;
@@ -60,19 +95,20 @@ namespace microc {
         using compare_function = Compare;
         using key_extract_function = KeyExtractFunction;
         using allocator_type = Allocator;
+        using augmentation = Augmentation;
         using size_type = microc::size_t;
 
     private:
-        struct node_t {
+        struct node_t : Augmentation::node_data {
             StoreItemType item;
             int height;
-            node_t *left, *right;
+            node_t *left, *right, *parent;
 
             explicit node_t(const StoreItemType &k) : item(k), left(nullptr),
-                                             right(nullptr), height(-1) {}
+                                             right(nullptr), parent(nullptr), height(-1) {}
 
             explicit node_t(StoreItemType &&k) : item(microc::traits::move(k)), left(nullptr),
-                                        right(nullptr), height(-1) {}
+                                        right(nullptr), parent(nullptr), height(-1) {}
         };
 
         template<class value_reference_type>
@@ -120,6 +156,8 @@ namespace microc {
             insert_result_t(const const_iterator &a, bool b) : first(a), second(b) {}
         };
         static constexpr unsigned long node_type_size = sizeof(node_type);
+        // the height of an AVL tree with n nodes is less than 1.45*log2(n+2)
+        static constexpr int max_height = int(sizeof(size_type) * 8 * 3 / 2) + 2;
 
         // iterators
         iterator begin() noexcept { return iterator{minimum()}; }
@@ -145,12 +183,12 @@ namespace microc {
         avl_tree(const Allocator &allocator = Allocator()) :
                 avl_tree(Compare(), allocator) {};
         avl_tree(const avl_tree &other, const Allocator &allocator) :
-                avl_tree(allocator) {
+                avl_tree(other._compare, allocator) {
             for (const auto &key: other) insert(key);
         }
         avl_tree(const avl_tree &other) : avl_tree(other, other.get_allocator()) {}
         avl_tree(avl_tree &&other, const Allocator &allocator) :
-                avl_tree(allocator) {
+                avl_tree(other._compare, allocator) {
             const bool are_equal_allocators = _alloc == allocator;
             if (are_equal_allocators) {
                 _root = other._root;
@@ -205,43 +243,26 @@ namespace microc {
         bool contains(const StoreItemType &k) const { return internal_contains(root(), extract_key(k)); }
         bool contains_by_key(const key_type &k) const { return internal_contains_by_key(root(), k); }
 
-        const_iterator findLowerBoundOf(const StoreItemType &key) const {
-            const node_t *root = root();
-            node_t *candidate = nullptr;
-            while (root != nullptr) {
-                bool has_left = root->left != nullptr;
-                bool has_right = root->right != nullptr;
-                // if _root item is before me, then he might be a candidate,
-                // let's store it, and try to get_or_put better
-                if (!isPreceding(key, root->item)) {
-                    candidate = root;
-                    // let's try to get_or_put a bigger lower bound
-                    if (has_right) root = root->right;
-                    else break;
-                } else {
-                    if (has_left) root = root->left;
-                    else break;
+        // first item, that is not less than the key
+        const_iterator lower_bound(const key_type &k) const {
+            const node_t *candidate = nullptr;
+            for (const node_t *node = root(); node;) {
+                if (isPreceding(extract_key(node->item), k)) node = node->right;
+                else {
+                    candidate = node;
+                    node = node->left;
                 }
             }
             return const_iterator(candidate, this);
         }
-        const_iterator findUpperBoundOf(const StoreItemType &key) const {
-            const node_t *root = root();
-            node_t *candidate = nullptr;
-            while (root != nullptr) {
-                bool has_left = root->left != nullptr;
-                bool has_right = root->right != nullptr;
-                // if _root item is before me, then he might be a candidate,
-                // let's store it, and try to get_or_put better
-                if (isPreceding(key, root->item)) {
-                    candidate = root;
-                    // let's try to get_or_put a bigger lower bound
-                    if (has_left) root = root->left;
-                    else break;
-                } else {
-                    if (has_right) root = root->right;
-                    else break;
-                }
+        // first item, that is greater than the key
+        const_iterator upper_bound(const key_type &k) const {
+            const node_t *candidate = nullptr;
+            for (const node_t *node = root(); node;) {
+                if (isPreceding(k, extract_key(node->item))) {
+                    candidate = node;
+                    node = node->left;
+                } else node = node->right;
             }
             return const_iterator(candidate, this);
         }
@@ -250,32 +271,53 @@ namespace microc {
         const_iterator maximum() const { return const_iterator(maximum_node(root()), this); }
 
         void clear() {
-            while (!empty()) { _root = remove_node_by_key(root(), nullptr, extract_key(root()->item)); }
+            destroy_tree(_root);
+            _root = nullptr;
             _size = 0;
         }
 
         // inserts, return the new root
         // todo: make it proper for move semantics with template, that constructs
         insert_result insert(const StoreItemType &k) {
-            node_t *new_node = nullptr;
             bool has_succeeded = false;
-            _root = insert_node(root(), k, &new_node, has_succeeded, false);
-            return insert_result(const_iterator(new_node, this), has_succeeded);
+            const node_t *node = insert_node(k, has_succeeded, false);
+            return insert_result(const_iterator(node, this), has_succeeded);
         }
         insert_result insert(StoreItemType &&item) {
-            node_t *new_node = nullptr;
             bool has_succeeded = false;
-            _root = insert_node(root(), item,
-                                &new_node, has_succeeded, true);
-            return insert_result(const_iterator(new_node, this), has_succeeded);
+            const node_t *node = insert_node(item, has_succeeded, true);
+            return insert_result(const_iterator(node, this), has_succeeded);
         }
         template<class... Args>
         insert_result insert_emplace(Args &&... args) {
-            node_t *new_node = nullptr;
             bool has_succeeded = false;
-            _root = insert_node(root(), StoreItemType(microc::traits::forward<Args>(args)...),
-                                &new_node, has_succeeded, true);
-            return insert_result(const_iterator(new_node, this), has_succeeded);
+            StoreItemType item(microc::traits::forward<Args>(args)...);
+            const node_t *node = insert_node(item, has_succeeded, true);
+            return insert_result(const_iterator(node, this), has_succeeded);
+        }
+        /**
+         * Insert with a hint, the item belongs right before the hint or right after it. The
+         * neighbours of the hint are checked with two comparisons, then the node is linked
+         * locally and re-balanced up by the parent pointers, without a search from the root,
+         * so keys, that arrive in order with the last inserted item or end() as the hint,
+         * cost O(1) comparisons and amortized O(1) rotations each. A wrong hint falls back to insert.
+         */
+        insert_result insert_hint(const_iterator hint, const StoreItemType &item) {
+            bool has_succeeded = false;
+            const node_t *node = insert_node_hint(hint._n, item, has_succeeded, false);
+            return insert_result(const_iterator(node, this), has_succeeded);
+        }
+        insert_result insert_hint(const_iterator hint, StoreItemType &&item) {
+            bool has_succeeded = false;
+            const node_t *node = insert_node_hint(hint._n, item, has_succeeded, true);
+            return insert_result(const_iterator(node, this), has_succeeded);
+        }
+        template<class... Args>
+        insert_result insert_emplace_hint(const_iterator hint, Args &&... args) {
+            bool has_succeeded = false;
+            StoreItemType item(microc::traits::forward<Args>(args)...);
+            const node_t *node = insert_node_hint(hint._n, item, has_succeeded, true);
+            return insert_result(const_iterator(node, this), has_succeeded);
         }
 
         // returns the new root
@@ -288,13 +330,214 @@ namespace microc {
             const bool has_found_node = node != nullptr;
             const node_t *next_node = nullptr;
             if (has_found_node) {
-                next_node = successor(node, root());
-                _root = remove_node_by_key(root(), nullptr, k);
-                _size -= 1;
+                next_node = successor(node);
+                remove_node_by_key(k);
             }
             return const_iterator(next_node, this);
         }
 
+        /**
+         * Remove the items with keys in [lo, hi). The tree is split twice and the outer parts
+         * are joined, in O(log(n)), and the removed part is torn down in O(k), instead of k
+         * removals, that each search from the root and re-balance.
+         * @return count of removed items
+         */
+        size_type erase_range(const key_type &lo, const key_type &hi) {
+            if (empty() || !isPreceding(lo, hi)) return 0;
+            node_t *left = nullptr, *rest = nullptr, *middle = nullptr, *right = nullptr;
+            node_t *found = split_nodes(_root, lo, left, rest);
+            if (found) rest = join_nodes(nullptr, found, rest);
+            found = split_nodes(rest, hi, middle, right);
+            if (found) right = join_nodes(nullptr, found, right);
+            _root = join_nodes(left, right);
+            const size_type removed = destroy_tree(middle);
+            _size -= removed;
+            return removed;
+        }
+        // remove the items in [first, last) as erase_range does, nodes are relinked, so last stays valid
+        const_iterator remove_range(const_iterator first, const_iterator last) {
+            if (first == last) return last;
+            if (last != end()) {
+                erase_range(extract_key(*first), extract_key(*last));
+                return last;
+            }
+            node_t *left = nullptr, *right = nullptr;
+            node_t *found = split_nodes(_root, extract_key(*first), left, right);
+            if (found) right = join_nodes(nullptr, found, right);
+            _root = left;
+            _size -= destroy_tree(right);
+            return end();
+        }
+
+        /**
+         * Replace the items with a sorted range in linear time, the tree is built perfectly
+         * balanced bottom up, so heights are known and nothing is rotated
+         * @param first,last forward iterators of items, sorted by key without duplicates
+         * @param verify check the order first, and keep the tree as is if it is not sorted
+         * @return false if verify failed
+         */
+        template<class ForwardIt>
+        bool assign_sorted(ForwardIt first, ForwardIt last, bool verify=true) {
+            size_type count = 0;
+            if (!count_sorted(first, last, verify, count)) return false;
+            clear();
+            auto next = [&]() -> node_t * { node_t *node = new_node(*first); ++first; return node; };
+            _root = build_balanced(count, next);
+            _size = count;
+            return true;
+        }
+        /**
+         * Insert a sorted range, that may interleave with the items of the tree. A range, that is
+         * small relative to the tree, is inserted item by item in O(m*log(n)), otherwise the tree
+         * is flattened and rebuilt with the merged items in O(n+m). Keys, that are already present,
+         * keep their existing items.
+         * @param first,last forward iterators of items, sorted by key without duplicates
+         * @param verify check the order first, and keep the tree as is if it is not sorted
+         * @return false if verify failed
+         */
+        template<class ForwardIt>
+        bool insert_sorted(ForwardIt first, ForwardIt last, bool verify=true) {
+            size_type count = 0;
+            if (!count_sorted(first, last, verify, count)) return false;
+            if (empty()) return assign_sorted(first, last, false);
+            if (count * size_type(floor_log2(_size) + 1) < _size) {
+                for (; first != last; ++first) insert(*first);
+                return true;
+            }
+            node_t *vine = tree_to_vine();
+            // count the merged items, keys in both count once
+            size_type total = 0;
+            ForwardIt it = first;
+            for (const node_t *node = vine; node || it != last; ++total) {
+                if (it != last && (node == nullptr || isPreceding(extract_key(*it), extract_key(node->item)))) ++it;
+                else {
+                    if (it != last && !isPreceding(extract_key(node->item), extract_key(*it))) ++it;
+                    node = node->right;
+                }
+            }
+            auto next = [&]() -> node_t * {
+                if (first != last && (vine == nullptr || isPreceding(extract_key(*first), extract_key(vine->item)))) {
+                    node_t *node = new_node(*first);
+                    ++first;
+                    return node;
+                }
+                if (first != last && !isPreceding(extract_key(vine->item), extract_key(*first))) ++first;
+                node_t *node = vine;
+                vine = vine->right;
+                return node;
+            };
+            _root = build_balanced(total, next);
+            _size = total;
+            return true;
+        }
+
+        /**
+         * Split the tree at a key in O(log(n)), this tree keeps the keys less than the key.
+         * Without a sizes keeping augmentation, the sizes of the parts are counted in time
+         * linear in the smaller part.
+         * @param k key
+         * @return tree with the items of keys not less than the key
+         */
+        avl_tree split(const key_type &k) {
+            avl_tree right_tree(_compare, get_allocator());
+            node_t *left = nullptr, *right = nullptr;
+            node_t *found = split_nodes(_root, k, left, right);
+            if (found) right = join_nodes(nullptr, found, right);
+            const size_type left_size = left_size_of_split(left, right, _size,
+                            microc::traits::integral_constant<bool, Augmentation::keeps_sizes>());
+            right_tree._root = right;
+            right_tree._size = _size - left_size;
+            _root = left;
+            _size = left_size;
+            return right_tree;
+        }
+        /**
+         * Append the items of a tree, whose keys all succeed the keys of this tree, in O(log(n)).
+         * Other trees, or trees of unequal allocators, fall back to union_with.
+         * @param other tree, that is left empty
+         */
+        void join(avl_tree &other) {
+            if (this == &other || other.empty()) return;
+            const bool are_equal_allocators = _alloc == other.get_allocator();
+            if (!are_equal_allocators || (!empty() &&
+                    !isPreceding(extract_key(maximum_node(_root)->item), extract_key(minimum_node(other._root)->item)))) {
+                union_with(other);
+                return;
+            }
+            _root = join_nodes(_root, other._root);
+            _size += other._size;
+            other._root = nullptr;
+            other._size = 0;
+        }
+        /**
+         * Move the items of another tree into this tree, by relinking its nodes. Keys, that are
+         * in both trees, keep the item of this tree. Trees of unequal allocators insert item by item.
+         * @param other tree, that is left empty
+         */
+        void union_with(avl_tree &other) {
+            if (this == &other) return;
+            const bool are_equal_allocators = _alloc == other.get_allocator();
+            if (!are_equal_allocators) {
+                for (auto &item: other) insert(microc::traits::move(item));
+                other.clear();
+                return;
+            }
+            size_type duplicates = 0;
+            _root = union_nodes(_root, other._root, duplicates);
+            if (_root) _root->parent = nullptr;
+            _size += other._size - duplicates;
+            other._root = nullptr;
+            other._size = 0;
+        }
+        // keep the items, whose keys are in another tree
+        void intersect_with(const avl_tree &other) {
+            if (this == &other) return;
+            size_type kept = 0;
+            _root = intersect_nodes(_root, other._root, kept);
+            if (_root) _root->parent = nullptr;
+            _size = kept;
+        }
+        // remove the items, whose keys are in another tree
+        void difference_with(const avl_tree &other) {
+            if (this == &other) { clear(); return; }
+            size_type removed = 0;
+            _root = difference_nodes(_root, other._root, removed);
+            if (_root) _root->parent = nullptr;
+            _size -= removed;
+        }
+
+        // order statistics, need the avl_order_statistics augmentation
+        // count of items with keys less than a key
+        size_type rank_by_key(const key_type &k) const {
+            size_type rank = 0;
+            for (const node_t *node = root(); node;) {
+                if (isPreceding(extract_key(node->item), k)) {
+                    rank += Augmentation::size_of(node->left) + 1;
+                    node = node->right;
+                } else node = node->left;
+            }
+            return rank;
+        }
+        size_type rank(const StoreItemType &item) const { return rank_by_key(extract_key(item)); }
+        // the item at an index in order, or end
+        const_iterator select(size_type index) const {
+            for (const node_t *node = root(); node;) {
+                const size_type left_size = Augmentation::size_of(node->left);
+                if (index < left_size) node = node->left;
+                else if (index == left_size) return const_iterator(node, this);
+                else {
+                    index -= left_size + 1;
+                    node = node->right;
+                }
+            }
+            return end();
+        }
+        // count of items with keys in [lo, hi)
+        size_type count_range_by_key(const key_type &lo, const key_type &hi) const {
+            if (!isPreceding(lo, hi)) return 0;
+            return rank_by_key(hi) - rank_by_key(lo);
+        }
+
         // _compare keys
         bool isPreceding(const key_type &lhs, const key_type &rhs) const { return _compare(lhs, rhs); }
         bool isPrecedingOrEqual(const key_type &lhs, const key_type &rhs) const
@@ -316,174 +559,496 @@ namespace microc {
         }
         bool internal_contains(const node_t *root, const StoreItemType &k) const { return internal_contains_by_key(root, extract_key(k)); }
         bool internal_contains_by_key(const node_t *root, const key_type &k) const { return find_node_by_key(root, k) != nullptr; }
-        const node_t *successor(const node_t *node) const { return successor(node, root()); }
-        const node_t *successor(const node_t *node, const node_t *root) const {
+        static const node_t *successor(const node_t *node) {
             if (node == nullptr) return nullptr;
             if (node->right) return minimum_node(node->right);
-            const node_t *succ = nullptr;
-            // Start from root and search for successor down the tree
-            while (root) {
-                if (isPreceding(extract_key(node->item), extract_key(root->item))) {
-                    succ = root;
-                    root = root->left;
-                } else if (isPreceding(extract_key(root->item), extract_key(node->item)))
-                    root = root->right;
-                else break;
-            }
-            return succ;
-        }
-        const node_t *predecessor(const node_t *node) const { return predecessor(node, root()); }
-        const node_t *predecessor(const node_t *node, const node_t *root) const {
-            // find predecessor of node in root tree
+            // climb up, until we arrive from a left sub tree
+            const node_t *parent = node->parent;
+            while (parent && node == parent->right) {
+                node = parent;
+                parent = parent->parent;
+            }
+            return parent;
+        }
+        static const node_t *predecessor(const node_t *node) {
             if (node == nullptr) return nullptr;
             if (node->left) return maximum_node(node->left);
-            const node_t *pred = nullptr;
-            // Start from root and search for predecessor down the tree
-            while (root) {
-                if (isPreceding(node->item, root->item)) {
-                    root = root->left;
-                } else if (isPreceding(root->item, node->item)) {
-                    pred = root;
-                    root = root->right;
-                } else break;
+            // climb up, until we arrive from a right sub tree
+            const node_t *parent = node->parent;
+            while (parent && node == parent->left) {
+                node = parent;
+                parent = parent->parent;
             }
-            return pred;
+            return parent;
         }
         static const node_t *minimum_node(const node_t *node) {
             const node_t *current = node;
             while (current && current->left) current = current->left;
             return current;
         }
-        struct pair_node { node_t *first, *second; };
-        static pair_node minimum_node_with_parent(node_t *node, node_t *parent) {
-            node_t *current = node;
-            pair_node result;
-            result.first = node;
-            result.second = parent;
-            while (current && current->left) {
-                result.second = current;
-                current = current->left;
-                result.first = current;
-            }
-            return result;
-        }
         static const node_t *maximum_node(const node_t *node) {
             const node_t *iter = node;
             while (iter && iter->right) iter = iter->right;
             return iter;
         }
+        // post-order teardown of a sub tree in linear time, climbs up by the parent pointers, so no stack
+        // @return count of destroyed nodes
+        size_type destroy_tree(node_t *root) {
+            if (root == nullptr) return 0;
+            root->parent = nullptr;
+            size_type count = 0;
+            node_t *node = root;
+            while (node) {
+                if (node->left) node = node->left;
+                else if (node->right) node = node->right;
+                else {
+                    node_t *parent = node->parent;
+                    if (parent) {
+                        if (parent->left == node) parent->left = nullptr;
+                        else parent->right = nullptr;
+                    }
+                    node->~node_t();
+                    _alloc.deallocate(node);
+                    ++count;
+                    node = parent;
+                }
+            }
+            return count;
+        }
+        void destroy_node(node_t *node) {
+            node->~node_t();
+            _alloc.deallocate(node);
+        }
+        // set the children of a node, and fix its height
+        void attach(node_t *node, node_t *left, node_t *right) {
+            node->left = left;
+            node->right = right;
+            if (left) left->parent = node;
+            if (right) right->parent = node;
+            fix_height(node);
+        }
+        /**
+         * Join two trees and a middle node, keys of left < middle < keys of right, in time of
+         * the height difference. The middle node hangs on the spine of the taller tree, where
+         * heights meet, and the spine is re-balanced as after an insert.
+         * @return the root
+         */
+        node_t *join_nodes(node_t *left, node_t *middle, node_t *right) {
+            const int height_left = height_of_node(left), height_right = height_of_node(right);
+            if (height_left <= height_right + 1 && height_right <= height_left + 1) {
+                attach(middle, left, right);
+                middle->parent = nullptr;
+                return middle;
+            }
+            node_t **path[max_height];
+            int depth = 0;
+            const bool is_left_taller = height_left > height_right;
+            node_t *root = is_left_taller ? left : right, **link = &root, *parent = nullptr;
+            const int height = (is_left_taller ? height_right : height_left) + 1;
+            while (height_of_node(*link) > height) {
+                path[depth++] = link;
+                parent = *link;
+                link = is_left_taller ? &parent->right : &parent->left;
+            }
+            if (is_left_taller) attach(middle, *link, right);
+            else attach(middle, left, *link);
+            middle->parent = parent;
+            *link = middle;
+            re_balance_path(path, depth);
+            root->parent = nullptr;
+            return root;
+        }
+        // join two trees, keys of left < keys of right, the minimum of right is the middle node
+        node_t *join_nodes(node_t *left, node_t *right) {
+            if (left == nullptr) return right;
+            if (right == nullptr) return left;
+            node_t **path[max_height];
+            int depth = 0;
+            node_t *root = right, **link = &root;
+            while ((*link)->left) {
+                path[depth++] = link;
+                link = &(*link)->left;
+            }
+            node_t *minimum = *link;
+            *link = minimum->right;
+            if (minimum->right) minimum->right->parent = minimum->parent;
+            re_balance_path(path, depth);
+            if (root) root->parent = nullptr;
+            return join_nodes(left, minimum, root);
+        }
+        /**
+         * Split a tree at a key, in O(log(n)), the path to the key is joined back bottom up
+         * @param root the tree
+         * @param k key
+         * @param left output, tree of the keys less than the key
+         * @param right output, tree of the keys greater than the key
+         * @return detached node of the key, or nullptr
+         */
+        node_t *split_nodes(node_t *root, const key_type &k, node_t *&left, node_t *&right) {
+            node_t *path[max_height];
+            bool went_left[max_height];
+            int depth = 0;
+            node_t *node = root, *found = nullptr;
+            while (node) {
+                if (isPreceding(k, extract_key(node->item))) {
+                    path[depth] = node;
+                    went_left[depth++] = true;
+                    node = node->left;
+                } else if (isPreceding(extract_key(node->item), k)) {
+                    path[depth] = node;
+                    went_left[depth++] = false;
+                    node = node->right;
+                } else {
+                    found = node;
+                    break;
+                }
+            }
+            left = found ? found->left : nullptr;
+            right = found ? found->right : nullptr;
+            if (left) left->parent = nullptr;
+            if (right) right->parent = nullptr;
+            while (depth--) {
+                node = path[depth];
+                if (went_left[depth]) right = join_nodes(right, node, node->right);
+                else left = join_nodes(node->left, node, left);
+            }
+            if (found) {
+                found->left = found->right = found->parent = nullptr;
+                fix_height(found);
+            }
+            return found;
+        }
+        // size of the left part of a split, from the sizes of the augmentation
+        size_type left_size_of_split(const node_t *left, const node_t *, size_type,
+                                     microc::traits::true_type) const {
+            return Augmentation::size_of(left);
+        }
+        // size of the left part of a split, by counting both parts together until one ends
+        size_type left_size_of_split(const node_t *left, const node_t *right, size_type total,
+                                     microc::traits::false_type) const {
+            const node_t *l = minimum_node(left), *r = minimum_node(right);
+            size_type count = 0;
+            for (; l && r; ++count) {
+                l = successor(l);
+                r = successor(r);
+            }
+            return l ? total - count : count;
+        }
+        // union, split b by the root of a, and union the sides
+        node_t *union_nodes(node_t *a, node_t *b, size_type &duplicates) {
+            if (a == nullptr) return b;
+            if (b == nullptr) return a;
+            node_t *b_left = nullptr, *b_right = nullptr;
+            node_t *duplicate = split_nodes(b, extract_key(a->item), b_left, b_right);
+            if (duplicate) {
+                destroy_node(duplicate);
+                ++duplicates;
+            }
+            node_t *a_left = a->left, *a_right = a->right;
+            if (a_left) a_left->parent = nullptr;
+            if (a_right) a_right->parent = nullptr;
+            node_t *left = union_nodes(a_left, b_left, duplicates);
+            node_t *right = union_nodes(a_right, b_right, duplicates);
+            return join_nodes(left, a, right);
+        }
+        // intersection, split a by the root of b, and intersect the sides, b is only read
+        node_t *intersect_nodes(node_t *a, const node_t *b, size_type &kept) {
+            if (a == nullptr) return nullptr;
+            if (b == nullptr) {
+                destroy_tree(a);
+                return nullptr;
+            }
+            node_t *a_left = nullptr, *a_right = nullptr;
+            node_t *found = split_nodes(a, extract_key(b->item), a_left, a_right);
+            node_t *left = intersect_nodes(a_left, b->left, kept);
+            node_t *right = intersect_nodes(a_right, b->right, kept);
+            if (found == nullptr) return join_nodes(left, right);
+            ++kept;
+            return join_nodes(left, found, right);
+        }
+        // difference, split a by the root of b, and subtract the sides, b is only read
+        node_t *difference_nodes(node_t *a, const node_t *b, size_type &removed) {
+            if (a == nullptr || b == nullptr) return a;
+            node_t *a_left = nullptr, *a_right = nullptr;
+            node_t *found = split_nodes(a, extract_key(b->item), a_left, a_right);
+            if (found) {
+                destroy_node(found);
+                ++removed;
+            }
+            node_t *left = difference_nodes(a_left, b->left, removed);
+            node_t *right = difference_nodes(a_right, b->right, removed);
+            return join_nodes(left, right);
+        }
+        static int floor_log2(size_type value) {
+            int log = -1;
+            for (; value; value >>= 1) ++log;
+            return log;
+        }
+        template<class Item>
+        node_t *new_node(Item &&item) {
+            auto *mem = _alloc.allocate(1);
+            ::new(mem, microc_new::blah) node_t(microc::traits::forward<Item>(item));
+            return mem;
+        }
+        /**
+         * Count a range of items, and optionally verify, that keys are strictly increasing
+         * @return false if verify failed
+         */
+        template<class ForwardIt>
+        bool count_sorted(ForwardIt first, ForwardIt last, bool verify, size_type &count) const {
+            count = 0;
+            for (ForwardIt previous = first; first != last; previous = first, ++first, ++count)
+                if (verify && count && !isPreceding(extract_key(*previous), extract_key(*first)))
+                    return false;
+            return true;
+        }
+        /**
+         * Flatten the tree into a vine, nodes in order linked by their right pointers, by right
+         * rotations in linear time. Other links of the nodes are left stale.
+         * @return the first node of the vine
+         */
+        node_t *tree_to_vine() {
+            node_t *vine = nullptr, **tail = &vine, *rest = _root;
+            while (rest) {
+                if (rest->left == nullptr) {
+                    *tail = rest;
+                    tail = &rest->right;
+                    rest = rest->right;
+                } else {
+                    node_t *left = rest->left;
+                    rest->left = left->right;
+                    left->right = rest;
+                    rest = left;
+                }
+            }
+            _root = nullptr;
+            return vine;
+        }
+        /**
+         * Build a perfectly balanced tree of nodes, that are handed in order, iteratively in linear time.
+         * Sub tree sizes of every node differ by at most one, so a sub tree of n nodes has height
+         * floor(log2(n)), and it is a valid AVL tree.
+         * @param count count of nodes
+         * @param next returns the next node in order, its links are set here
+         * @return the root
+         */
+        template<class Next>
+        node_t *build_balanced(size_type count, Next &next) {
+            struct frame_t { size_type count; node_t *node; int stage; };
+            frame_t stack[max_height];
+            int depth = 0;
+            node_t *built = nullptr; // the last built sub tree
+            stack[depth++] = { count, nullptr, 0 };
+            while (depth) {
+                frame_t &frame = stack[depth - 1];
+                const size_type left_count = frame.count ? (frame.count - 1) / 2 : 0;
+                if (frame.count == 0) {
+                    built = nullptr;
+                    --depth;
+                } else if (frame.stage == 0) {
+                    frame.stage = 1;
+                    stack[depth++] = { left_count, nullptr, 0 };
+                } else if (frame.stage == 1) {
+                    node_t *node = next();
+                    node->left = built;
+                    if (built) built->parent = node;
+                    frame.node = node;
+                    frame.stage = 2;
+                    stack[depth++] = { frame.count - 1 - left_count, nullptr, 0 };
+                } else {
+                    node_t *node = frame.node;
+                    node->right = built;
+                    if (built) built->parent = node;
+                    node->height = floor_log2(frame.count);
+                    Augmentation::update(node);
+                    built = node;
+                    --depth;
+                }
+            }
+            if (built) built->parent = nullptr;
+            return built;
+        }
+        /**
+         * re-balance the nodes on the path bottom up, until a sub tree keeps its height,
+         * augmenting trees keep updating the rest of the path
+         * @param path links from the root down to the parent of the changed position
+         * @param depth count of links in the path
+         */
+        void re_balance_path(node_t **path[], int depth) {
+            while (depth--) {
+                node_t **link = path[depth];
+                const int height = (*link)->height;
+                *link = re_balance(*link);
+                if ((*link)->height == height) break;
+            }
+            if (Augmentation::is_augmenting)
+                while (depth-- > 0) Augmentation::update(*path[depth]);
+        }
+        // re-balance up from a node by the parent pointers, after a leaf was linked below it
+        void re_balance_up(node_t *node) {
+            bool is_balanced = false;
+            while (node) {
+                node_t *parent = node->parent;
+                if (is_balanced) Augmentation::update(node);
+                else {
+                    node_t **link = parent ? (parent->left == node ? &parent->left : &parent->right) : &_root;
+                    const int height = node->height;
+                    *link = re_balance(node);
+                    if ((*link)->height == height) {
+                        if (!Augmentation::is_augmenting) break;
+                        is_balanced = true;
+                    }
+                }
+                node = parent;
+            }
+        }
         /**
          * Insert a item
-         * @param root Tree root
          * @param item item
-         * @param new_node New node or existing if item is already present
          * @param has_succeeded True if new node created. False, otherwise;
-         * @return The new root of the tree
+         * @param move_ctor move construct the item
+         * @return New node or existing if item is already present
          */
-        node_t *insert_node(node_t *root, const StoreItemType &item, // root is a sub tree root
-                            node_t **new_node, bool &has_succeeded, const bool move_ctor) {
-            if (root == nullptr) {
-                auto *mem = _alloc.allocate(1);
-                if (move_ctor) ::new(mem, microc_new::blah) node_t(microc::traits::move(const_cast<StoreItemType &>(item)));
-                else ::new(mem, microc_new::blah) node_t(item);
-                has_succeeded = true;
-                *new_node = mem;
-                _size += 1;
-                return mem;
-            } else if (isPreceding(extract_key(item), extract_key(root->item))) {
-                root->left = insert_node(root->left, item, new_node, has_succeeded, move_ctor);
-            } else if (isSucceeding(extract_key(item), extract_key(root->item))) {
-                root->right = insert_node(root->right, item, new_node, has_succeeded, move_ctor);
-            } else {
+        node_t *insert_node(const StoreItemType &item, bool &has_succeeded, const bool move_ctor) {
+            node_t **path[max_height];
+            int depth = 0;
+            node_t **link = &_root;
+            node_t *parent = nullptr;
+            const key_type &key = extract_key(item);
+            while (*link != nullptr) {
+                node_t *node = *link;
+                parent = node;
+                if (isPreceding(key, extract_key(node->item))) {
+                    path[depth++] = link;
+                    link = &node->left;
+                } else if (isSucceeding(key, extract_key(node->item))) {
+                    path[depth++] = link;
+                    link = &node->right;
+                } else { // duplicate keys
+                    has_succeeded = false;
+                    return node;
+                }
+            }
+            auto *mem = _alloc.allocate(1);
+            if (move_ctor) ::new(mem, microc_new::blah) node_t(microc::traits::move(const_cast<StoreItemType &>(item)));
+            else ::new(mem, microc_new::blah) node_t(item);
+            fix_height(mem);
+            mem->parent = parent;
+            *link = mem;
+            has_succeeded = true;
+            _size += 1;
+            re_balance_path(path, depth);
+            return mem;
+        }
+
+        /**
+         * Insert a item next to a hint, see insert_hint
+         * @param hint node, the item is expected right before it or right after it, nullptr is end
+         * @return New node or existing if item is already present
+         */
+        node_t *insert_node_hint(const node_t *hint, const StoreItemType &item, bool &has_succeeded,
+                                 const bool move_ctor) {
+            const key_type &key = extract_key(item);
+            node_t *parent = nullptr;
+            bool is_left = false;
+            if (hint == nullptr) { // after the maximum
+                const node_t *maximum = maximum_node(root());
+                if (maximum && isPreceding(extract_key(maximum->item), key)) parent = const_cast<node_t *>(maximum);
+            } else if (isPreceding(key, extract_key(hint->item))) {
+                const node_t *before = predecessor(hint);
+                if (before == nullptr || isPreceding(extract_key(before->item), key)) {
+                    // the free link between them, the left of the hint or the right of its predecessor
+                    is_left = hint->left == nullptr;
+                    parent = const_cast<node_t *>(is_left ? hint : before);
+                }
+            } else if (isPreceding(extract_key(hint->item), key)) {
+                const node_t *after = successor(hint);
+                if (after == nullptr || isPreceding(key, extract_key(after->item))) {
+                    is_left = hint->right != nullptr;
+                    parent = const_cast<node_t *>(is_left ? after : hint);
+                }
+            } else { // duplicate keys
                 has_succeeded = false;
-                *new_node = root;
-                return root;
-            } // duplicate keys
-            return re_balance(root);
-        }
-
-        pair_node swap_nodes(node_t *a, node_t *a_parent,
-                             node_t *b, node_t *b_parent) {
-            bool a_has_parent = a_parent != nullptr;
-            bool b_has_parent = b_parent != nullptr;
-            bool a_on_left = a_has_parent && a_parent->left == a;
-            bool b_on_left = b_has_parent && b_parent->left == b;
-            bool a_is_left_child_of_b = b && a && b->left == a;
-            bool a_is_right_child_of_b = b && a && b->right == a;
-            bool b_is_left_child_of_a = b && a && a->left == b;
-            bool b_is_right_child_of_a = b && a && a->right == b;
-            node_t *temp_left = a->left, *temp_right = a->right;
-            node_t *temp_p = a;
-            a->left = b->left;
-            a->right = b->right;
-            b->left = temp_left;
-            b->right = temp_right;
-            a = b;
-            b = temp_p;
-            if (a_has_parent) {
-                if (a_is_left_child_of_b) b->left = a;
-                else if (a_is_right_child_of_b) b->right = a;
-                else if (a_on_left) a_parent->left = a;
-                else a_parent->right = a;
-            }
-            if (b_has_parent) {
-                if (b_is_left_child_of_a) a->left = b;
-                else if (b_is_right_child_of_a) a->right = b;
-                else if (b_on_left) b_parent->left = b;
-                else b_parent->right = b;
-            }
-            pair_node result;
-            result.first = a;
-            result.second = b;
-            return result;
+                return const_cast<node_t *>(hint);
+            }
+            if (parent == nullptr) return insert_node(item, has_succeeded, move_ctor);
+            auto *mem = _alloc.allocate(1);
+            if (move_ctor) ::new(mem, microc_new::blah) node_t(microc::traits::move(const_cast<StoreItemType &>(item)));
+            else ::new(mem, microc_new::blah) node_t(item);
+            fix_height(mem);
+            mem->parent = parent;
+            (is_left ? parent->left : parent->right) = mem;
+            has_succeeded = true;
+            _size += 1;
+            re_balance_up(parent);
+            return mem;
         }
 
         /**
-         * Remove a root
-         * @param root Tree root
-         * @param k item
-         * @param next_node Next root after removal
-         * @return The new root
+         * Remove the node of a key, a node with two children is replaced by its successor node,
+         * so nodes never change their items and iterators to other nodes stay valid.
+         * @param k key
+         * @return True if the key was found and removed
          */
-        node_t *remove_node(node_t *root, node_t *root_parent, const StoreItemType &k) {
-            return remove_node_by_key(root, root_parent, extract_key(k));
-        }
-        node_t *remove_node_by_key(node_t *root, node_t *root_parent, const key_type &k) {
-            if (root == nullptr) return nullptr;
-            else if (isPreceding(k, extract_key(root->item))) {
-                root->left = remove_node_by_key(root->left, root, k);
-            } else if (isPreceding(extract_key(root->item), k)) {
-                root->right = remove_node_by_key(root->right, root, k);
-            } else {
-                if (root->left == nullptr || root->right == nullptr) {
-                    //  if is leaf
-                    auto *node_to_remove = root;
-                    root = (root->left) ? root->left : root->right;
-                    node_to_remove->~node_t();
-                    _alloc.deallocate(node_to_remove);
-                } else {
-                    //  replace with successor = left most in right tree, and then remove_node_by_partial_key successor
-                    pair_node min = minimum_node_with_parent(const_cast<node_t *>(root->right),
-                                                             const_cast<node_t *>(root));
-                    auto *successor = min.first;
-                    auto *og_successor_parent = min.second;
-                    auto result = swap_nodes(root, root_parent, successor, og_successor_parent);
-                    root = result.first;
-                    root->right = remove_node_by_key(root->right, root, k);
+        bool remove_node_by_key(const key_type &k) {
+            node_t **path[max_height];
+            int depth = 0;
+            node_t **link = &_root;
+            while (*link != nullptr) {
+                node_t *node = *link;
+                if (isPreceding(k, extract_key(node->item))) {
+                    path[depth++] = link;
+                    link = &node->left;
+                } else if (isPreceding(extract_key(node->item), k)) {
+                    path[depth++] = link;
+                    link = &node->right;
+                } else break;
+            }
+            node_t *node = *link;
+            if (node == nullptr) return false;
+            if (node->left && node->right) {
+                //  replace with successor = left most in right tree
+                const int node_depth = depth;
+                path[depth++] = link;
+                node_t **successor_link = &node->right;
+                while ((*successor_link)->left) {
+                    path[depth++] = successor_link;
+                    successor_link = &(*successor_link)->left;
                 }
+                node_t *successor = *successor_link;
+                *successor_link = successor->right;
+                if (successor->right) successor->right->parent = successor->parent;
+                successor->left = node->left;
+                successor->right = node->right;
+                successor->height = node->height;
+                successor->parent = node->parent;
+                if (successor->left) successor->left->parent = successor;
+                if (successor->right) successor->right->parent = successor;
+                *link = successor;
+                // the link below the replaced node belongs to the successor now
+                if (depth > node_depth + 1) path[node_depth + 1] = &successor->right;
+            } else {
+                node_t *child = node->left ? node->left : node->right;
+                if (child) child->parent = node->parent;
+                *link = child;
             }
-            if (root) root = re_balance(root);
-            return root;
+            node->~node_t();
+            _alloc.deallocate(node);
+            _size -= 1;
+            re_balance_path(path, depth);
+            return true;
         }
 
         int height_of_node(node_t *node) const { return node ? node->height : -1; }
         int balance_factor(node_t *node) const {
             return node == nullptr ? 0 : (height_of_node(node->right) - height_of_node(node->left));
         }
+        // fix the height and the augmentation of a node, after its children changed
         void fix_height(node_t *node) {
             auto hl = height_of_node(node->left);
             auto hr = height_of_node(node->right);
             node->height = (hl > hr ? hl : hr) + 1;
+            Augmentation::update(node);
         }
 
         /**
@@ -499,6 +1064,9 @@ namespace microc {
             node_t *z = x->right;
             x->right = y;
             y->left = z;
+            x->parent = y->parent;
+            y->parent = x;
+            if (z) z->parent = y;
             fix_height(y);
             fix_height(x);
             return x;
@@ -517,23 +1085,27 @@ namespace microc {
             node_t *z = x->left;
             x->left = y;
             y->right = z;
+            x->parent = y->parent;
+            y->parent = x;
+            if (z) z->parent = y;
             fix_height(y);
             fix_height(x);
             return x;
         }
 
+        // a child with balanced sub trees only happens after removal, and needs a single rotation
         node_t *re_balance(node_t *node) { // balancing the node node_t
             fix_height(node);
             auto balance = balance_factor(node);
             if (balance > 1) {
-                if (height_of_node(node->right->right) > height_of_node(node->right->left))
+                if (height_of_node(node->right->right) >= height_of_node(node->right->left))
                     node = rotate_left(node);
                 else {
                     node->right = rotate_right(node->right);
                     node = rotate_left(node);
                 }
             } else if (balance < -1) {
-                if (height_of_node(node->left->left) > height_of_node(node->left->right))
+                if (height_of_node(node->left->left) >= height_of_node(node->left->right))
                     node = rotate_right(node);
                 else {
                     node->left = rotate_left(node->left);
@@ -544,12 +1116,24 @@ namespace microc {
         }
     };
 
+    /**
+     * Selects an avl_tree as the tree of dictionary and ordered_set
+     */
+    template<class Augmentation>
+    struct avl_augmented_backend {
+        template<class StoreItemType, class Key, class Compare, class KeyExtractFunction, class Allocator>
+        using tree = avl_tree<StoreItemType, Key, Compare, KeyExtractFunction, Allocator, Augmentation>;
+    };
+    using avl_tree_backend = avl_augmented_backend<avl_no_augmentation>;
+    // enables rank, nth and count_range of dictionary and ordered_set
+    using avl_order_statistics_backend = avl_augmented_backend<avl_order_statistics>;
+
     template<class StoreItemType, class Key, class Compare,
-            class KeyExtractFunction, class Allocator>
-    bool operator==(const avl_tree<StoreItemType, Key, Compare, KeyExtractFunction, Allocator>& lhs,
-                    const avl_tree<StoreItemType, Key, Compare, KeyExtractFunction, Allocator>& rhs ) {
+            class KeyExtractFunction, class Allocator, class Augmentation>
+    bool operator==(const avl_tree<StoreItemType, Key, Compare, KeyExtractFunction, Allocator, Augmentation>& lhs,
+                    const avl_tree<StoreItemType, Key, Compare, KeyExtractFunction, Allocator, Augmentation>& rhs ) {
         if(!(lhs.size()==rhs.size())) return false;
-        using size_type = typename avl_tree<StoreItemType, Key, Compare, KeyExtractFunction, Allocator>::size_type;
+        using size_type = typename avl_tree<StoreItemType, Key, Compare, KeyExtractFunction, Allocator, Augmentation>::size_type;
         for (size_type ix = 0; ix < lhs.size(); ++ix)
             if(!(lhs[ix]==rhs[ix])) return false;
         return true;
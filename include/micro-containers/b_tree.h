@@ -0,0 +1,760 @@
+/*========================================================================================
+ Copyright (2021), Tomer Shalev (tomer.shalev@gmail.com, https://github.com/HendrixString).
+ All Rights Reserved.
+ License is a custom open source semi-permissive license with the following guidelines:
+ 1. unless otherwise stated, derivative work and usage of this file is permitted and
+    should be credited to the project and the author of this project.
+ 2. Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+========================================================================================*/
+#pragma once
+
+#include "traits.h"
+
+namespace microc {
+    /**
+     * Interface for key comparison
+     */
+    template<class Key>
+    struct b_tree_less {
+        bool operator()(const Key &lhs, const Key &rhs) const { return lhs < rhs; }
+    };
+
+    /**
+     * This function extracts reference to the key of a stored item
+     */
+    template<class Item, class Key>
+    struct b_tree_key_extract {
+        using key = Key;
+        using item = Item;
+        const Key & operator()(const Item &whole) const { return whole; }
+    };
+
+    /**
+     * B+ Tree, an ordered tree, that stores items in arrays, logarithmic complexity everything.
+     * Notes:
+     * - Items are stored in leaves, that hold up to Order items and are linked to their
+     *   neighbours, so iterating is a walk over arrays. Inner nodes hold up to Order children
+     *   and copies of keys, that separate them, so a lookup touches a handful of nodes
+     * - Items move between nodes on insert and remove, so iterators are invalidated by
+     *   modifications, unlike avl_tree
+     * - The Key type has to be copy constructible, as inner nodes keep copies of keys
+     * - This class is Allocator-Aware
+     * - KeyExtractFunction type is a function struct, that given a stored type, can compute a
+     *   reference to a comparable key (see avl_tree)
+     * @tparam StoreItemType The item type, that the tree stores
+     * @tparam Key The key type, that is used to compare StoreItemType, usually a sub-type of StoreItemType or StoreItemType itself
+     * @tparam Compare compare structure to compare keys less than binary relation (key_1 < key_2)
+     * @tparam KeyExtractFunction (Optional) Extract a key from the stored item object, by default the StoreItemType is the key
+     * @tparam Allocator allocator type
+     * @tparam Order max items of a leaf and max children of an inner node
+     */
+    template<class StoreItemType,
+             class Key=StoreItemType,
+             class Compare=b_tree_less<Key>,
+             class KeyExtractFunction=b_tree_key_extract<StoreItemType, Key>,
+             class Allocator=microc::std_allocator<char>,
+             unsigned Order=32>
+    class b_tree {
+    public:
+        using store_item_type = StoreItemType;
+        using key_type = Key;
+        using compare_function = Compare;
+        using key_extract_function = KeyExtractFunction;
+        using allocator_type = Allocator;
+        using size_type = microc::size_t;
+        static_assert(Order >= 4, "b_tree Order has to be at least 4");
+
+    private:
+        static constexpr int max_items = int(Order);
+        static constexpr int min_leaf_items = int(Order / 2);
+        static constexpr int min_children = int((Order + 1) / 2);
+
+        struct node_t {
+            int count; // items of a leaf, children of an inner node
+        };
+        struct leaf_t : node_t {
+            leaf_t *prev, *next;
+            alignas(StoreItemType) unsigned char storage[sizeof(StoreItemType) * Order];
+            StoreItemType * items() { return reinterpret_cast<StoreItemType *>(storage); }
+            const StoreItemType * items() const { return reinterpret_cast<const StoreItemType *>(storage); }
+        };
+        struct inner_t : node_t {
+            node_t * children[Order];
+            // keys[i] separates children[i] and children[i+1], keys[i] <= keys of children[i+1]
+            alignas(key_type) unsigned char storage[sizeof(key_type) * (Order - 1)];
+            key_type * keys() { return reinterpret_cast<key_type *>(storage); }
+            const key_type * keys() const { return reinterpret_cast<const key_type *>(storage); }
+        };
+        struct path_t { inner_t * node; int index; };
+
+        template<class value_reference_type>
+        struct iterator_t {
+            const leaf_t *_l; // leaf, nullptr leaf is end signal
+            int _i; // index in leaf
+            const b_tree *_t; // tree
+
+            leaf_t *ncn(const leaf_t *leaf) const { return const_cast<leaf_t *>(leaf); }
+
+            template<class value_reference_type_t>
+            iterator_t(const iterator_t<value_reference_type_t> &o) : iterator_t(o._l, o._i, o._t) {}
+
+            explicit iterator_t(const leaf_t *l, int i, const b_tree *t) : _l(l), _i(i), _t(t) {}
+
+            iterator_t &operator++() {
+                if (++_i == _l->count) { _l = _l->next; _i = 0; }
+                return *this;
+            }
+            iterator_t &operator--() {
+                if (_l == nullptr) { _l = _t->_last; _i = _l->count - 1; }
+                else if (_i == 0) { _l = _l->prev; _i = _l->count - 1; }
+                else --_i;
+                return *this;
+            }
+            iterator_t operator++(int) {
+                iterator_t ret(_l, _i, _t);
+                ++(*this);
+                return ret;
+            }
+            iterator_t operator--(int) {
+                iterator_t ret(_l, _i, _t);
+                --(*this);
+                return ret;
+            }
+            bool operator==(iterator_t o) const { return _l == o._l && _i == o._i; }
+            bool operator!=(iterator_t o) const { return !(*this == o); }
+            value_reference_type operator*() const { return ncn(_l)->items()[_i]; }
+        };
+
+    public:
+        using node_type = leaf_t;
+        using inner_node_type = inner_t;
+        using iterator = iterator_t<StoreItemType &>;
+        using const_iterator = iterator_t<const StoreItemType &>;
+        using rebind_alloc = typename Allocator::template rebind<leaf_t>::other;
+        using rebind_inner_alloc = typename Allocator::template rebind<inner_t>::other;
+        using insert_result = struct insert_result_t {
+            const_iterator first; bool second;
+            insert_result_t(const const_iterator &a, bool b) : first(a), second(b) {}
+        };
+        static constexpr unsigned long node_type_size = sizeof(node_type);
+        static constexpr unsigned long inner_node_type_size = sizeof(inner_node_type);
+        // every inner node but the root has at least two children
+        static constexpr int max_height = int(sizeof(size_type) * 8) + 1;
+
+        // iterators
+        iterator begin() noexcept { return iterator(_first, 0, this); }
+        const_iterator begin() const noexcept { return const_iterator(_first, 0, this); }
+        const_iterator cbegin() const noexcept { return begin(); }
+        iterator end() noexcept { return iterator(nullptr, 0, this); }
+        const_iterator end() const noexcept { return const_iterator(nullptr, 0, this); }
+        const_iterator cend() const noexcept { return end(); }
+        const key_type & extract_key(const StoreItemType & item) const
+        { return _partial(item); }
+
+    private:
+        Compare _compare;
+        key_extract_function _partial;
+        node_t *_root;
+        leaf_t *_first, *_last;
+        int _height; // count of inner levels above the leaves
+        rebind_alloc _alloc;
+        rebind_inner_alloc _inner_alloc;
+        size_type _size;
+
+    public:
+        b_tree(const Compare &comp,
+               const Allocator &allocator = Allocator()) :
+                _compare(comp), _partial(), _root(nullptr), _first(nullptr), _last(nullptr),
+                _height(0), _alloc(allocator), _inner_alloc(allocator), _size(0) {};
+        b_tree(const Allocator &allocator = Allocator()) :
+                b_tree(Compare(), allocator) {};
+        b_tree(const b_tree &other, const Allocator &allocator) :
+                b_tree(other._compare, allocator) {
+            // the items of other are sorted, so the copy is built bottom up in linear time
+            assign_sorted(other.begin(), other.end(), false);
+        }
+        b_tree(const b_tree &other) : b_tree(other, other.get_allocator()) {}
+        b_tree(b_tree &&other, const Allocator &allocator) :
+                b_tree(other._compare, allocator) {
+            const bool are_equal_allocators = _alloc == allocator;
+            if (are_equal_allocators) steal(other);
+            else {
+                for (auto &item: other)
+                    insert(microc::traits::move(item));
+                other.clear();
+            }
+        }
+        b_tree(b_tree &&other) noexcept:
+                b_tree(microc::traits::move(other), other.get_allocator()) {}
+
+        ~b_tree() { clear(); }
+
+        b_tree &operator=(const b_tree &other) {
+            if (this != &(other)) assign_sorted(other.begin(), other.end(), false);
+            return *this;
+        }
+        b_tree &operator=(b_tree &&other) noexcept {
+            if (this != &(other)) {
+                clear();
+                const bool are_equal_allocators = _alloc == other.get_allocator();
+                if (are_equal_allocators) steal(other);
+                else {
+                    for (auto &item: other)
+                        insert(microc::traits::move(item));
+                    other.clear();
+                }
+            }
+            return *this;
+        }
+
+        Allocator get_allocator() const { return Allocator(_alloc); }
+        const Compare &get_comparator() const { return _compare; }
+        bool empty() const { return _size == 0; }
+        size_type size() const { return _size; }
+        int height() const { return _root ? _height + 1 : 0; }
+        const_iterator find(const StoreItemType &k) const { return find_by_key(extract_key(k)); }
+        const_iterator find_by_key(const key_type &k) const {
+            const leaf_t *leaf = leaf_of(k, nullptr, nullptr);
+            if (leaf == nullptr) return end();
+            const int pos = lower_bound_in_leaf(leaf, k);
+            if (pos < leaf->count && !isPreceding(k, extract_key(leaf->items()[pos])))
+                return const_iterator(leaf, pos, this);
+            return end();
+        }
+        bool contains(const StoreItemType &k) const { return find(k) != end(); }
+        bool contains_by_key(const key_type &k) const { return find_by_key(k) != end(); }
+        // first item, that is not less than the key
+        const_iterator lower_bound(const key_type &k) const {
+            const leaf_t *leaf = leaf_of(k, nullptr, nullptr);
+            return leaf ? position(leaf, lower_bound_in_leaf(leaf, k)) : end();
+        }
+        // first item, that is greater than the key
+        const_iterator upper_bound(const key_type &k) const {
+            const leaf_t *leaf = leaf_of(k, nullptr, nullptr);
+            return leaf ? position(leaf, upper_bound_in_leaf(leaf, k)) : end();
+        }
+        const_iterator minimum() const { return begin(); }
+        const_iterator maximum() const {
+            return _last ? const_iterator(_last, _last->count - 1, this) : end();
+        }
+
+        // linear teardown, leaves by their links, then inner nodes depth first with a path stack
+        void clear() {
+            for (leaf_t *leaf = _first; leaf;) {
+                leaf_t *next = leaf->next;
+                for (int ix = 0; ix < leaf->count; ++ix) leaf->items()[ix].~StoreItemType();
+                _alloc.deallocate(leaf);
+                leaf = next;
+            }
+            if (_height > 0) {
+                path_t path[max_height];
+                int depth = 0;
+                path[depth++] = { static_cast<inner_t *>(_root), 0 };
+                while (depth) {
+                    path_t &top = path[depth - 1];
+                    if (depth < _height && top.index < top.node->count) {
+                        path[depth++] = { static_cast<inner_t *>(top.node->children[top.index++]), 0 };
+                        continue;
+                    }
+                    for (int ix = 0; ix < top.node->count - 1; ++ix) top.node->keys()[ix].~key_type();
+                    _inner_alloc.deallocate(top.node);
+                    --depth;
+                }
+            }
+            _root = nullptr;
+            _first = _last = nullptr;
+            _height = 0;
+            _size = 0;
+        }
+
+        insert_result insert(const StoreItemType &item) {
+            bool has_succeeded = false;
+            const auto pos = insert_item(item, has_succeeded, false);
+            return insert_result(pos, has_succeeded);
+        }
+        insert_result insert(StoreItemType &&item) {
+            bool has_succeeded = false;
+            const auto pos = insert_item(item, has_succeeded, true);
+            return insert_result(pos, has_succeeded);
+        }
+        template<class... Args>
+        insert_result insert_emplace(Args &&... args) {
+            bool has_succeeded = false;
+            StoreItemType item(microc::traits::forward<Args>(args)...);
+            const auto pos = insert_item(item, has_succeeded, true);
+            return insert_result(pos, has_succeeded);
+        }
+        // the hint is not used, a split on the way up needs the path from the root anyway
+        insert_result insert_hint(const_iterator, const StoreItemType &item) { return insert(item); }
+        insert_result insert_hint(const_iterator, StoreItemType &&item) { return insert(microc::traits::move(item)); }
+        template<class... Args>
+        insert_result insert_emplace_hint(const_iterator, Args &&... args) {
+            return insert_emplace(microc::traits::forward<Args>(args)...);
+        }
+
+        // returns the position of the item, that followed the removed item
+        const_iterator remove(const StoreItemType &item) {
+            return remove_by_key(extract_key(item));
+        }
+        const_iterator remove_by_key(const key_type &k) {
+            path_t path[max_height];
+            int depth = 0;
+            leaf_t *leaf = leaf_of(k, path, &depth);
+            if (leaf == nullptr) return end();
+            int pos = lower_bound_in_leaf(leaf, k);
+            if (pos == leaf->count || isPreceding(k, extract_key(leaf->items()[pos])))
+                return end();
+            leaf->items()[pos].~StoreItemType();
+            move_items(leaf->items() + pos, leaf->items() + pos + 1, leaf->count - pos - 1);
+            leaf->count -= 1;
+            _size -= 1;
+            if (depth == 0) { // the leaf is the root
+                if (leaf->count == 0) { free_leaf(leaf); _root = nullptr; return end(); }
+                return position(leaf, pos);
+            }
+            if (leaf->count < min_leaf_items) leaf = re_balance_leaf(leaf, path[depth - 1], pos);
+            re_balance_path(path, depth - 1);
+            return position(leaf, pos);
+        }
+
+        /**
+         * Remove the items in [first, last), item by item, since the items of a b_tree move on
+         * remove, the range is counted first
+         * @return the position of the item, that followed the range
+         */
+        const_iterator remove_range(const_iterator first, const_iterator last) {
+            size_type count = 0;
+            for (const_iterator it(first); it != last; ++it) ++count;
+            const_iterator current(first);
+            while (count--) current = remove(*current);
+            return current;
+        }
+        // remove the items with keys in [lo, hi), returns the count of removed items
+        size_type erase_range(const key_type &lo, const key_type &hi) {
+            if (!isPreceding(lo, hi)) return 0;
+            const size_type size_before = _size;
+            remove_range(lower_bound(lo), lower_bound(hi));
+            return size_before - _size;
+        }
+
+        /**
+         * Replace the items with a sorted range in linear time. Leaves are filled left to right,
+         * with the items spread evenly, and every completed node is appended to its parent, so
+         * nothing is split or searched.
+         * @param first,last forward iterators of items, sorted by key without duplicates
+         * @param verify check the order first, and keep the tree as is if it is not sorted
+         * @return false if verify failed
+         */
+        template<class ForwardIt>
+        bool assign_sorted(ForwardIt first, ForwardIt last, bool verify=true) {
+            size_type count = 0;
+            if (!count_sorted(first, last, verify, count)) return false;
+            clear();
+            if (count == 0) return true;
+            // count of nodes per level, level 0 are the leaves
+            size_type nodes[max_height];
+            int levels = 0;
+            nodes[0] = (count + max_items - 1) / max_items;
+            while (nodes[levels] > 1) {
+                nodes[levels + 1] = (nodes[levels] + max_items - 1) / max_items;
+                ++levels;
+            }
+            // per level, the open node, the first leaf under it and its index in the level
+            inner_t *open[max_height];
+            leaf_t *open_first[max_height];
+            size_type index[max_height];
+            for (int level = 0; level <= levels; ++level) { open[level] = nullptr; index[level] = 0; }
+            for (size_type leaf_index = 0; leaf_index < nodes[0]; ++leaf_index) {
+                leaf_t *leaf = new_leaf();
+                const size_type items = count / nodes[0] + (leaf_index < count % nodes[0] ? 1 : 0);
+                for (; leaf->count < int(items); ++first, ++leaf->count)
+                    ::new(leaf->items() + leaf->count, microc_new::blah) StoreItemType(*first);
+                leaf->prev = _last;
+                if (_last) _last->next = leaf; else _first = leaf;
+                _last = leaf;
+                node_t *child = leaf;
+                leaf_t *child_first = leaf;
+                for (int level = 1; level <= levels; ++level) {
+                    inner_t *&node = open[level];
+                    if (node == nullptr) { node = new_inner(); open_first[level] = child_first; }
+                    if (node->count) copy_key(node->keys() + node->count - 1, child_first->items()[0]);
+                    node->children[node->count++] = child;
+                    const size_type children = nodes[level - 1] / nodes[level] +
+                            (index[level] < nodes[level - 1] % nodes[level] ? 1 : 0);
+                    if (size_type(node->count) < children) break;
+                    // completed, goes up to its parent
+                    child = node;
+                    child_first = open_first[level];
+                    node = nullptr;
+                    ++index[level];
+                }
+                if (leaf_index + 1 == nodes[0]) _root = child;
+            }
+            _height = levels;
+            _size = count;
+            return true;
+        }
+        /**
+         * Insert a sorted range, that may interleave with the items of the tree. An empty tree
+         * is built with assign_sorted, otherwise items are inserted one by one, consecutive items
+         * mostly land in the same leaf, which is hot in the cache. Keys, that are already present,
+         * keep their existing items.
+         * @param first,last forward iterators of items, sorted by key without duplicates
+         * @param verify check the order first, and keep the tree as is if it is not sorted
+         * @return false if verify failed
+         */
+        template<class ForwardIt>
+        bool insert_sorted(ForwardIt first, ForwardIt last, bool verify=true) {
+            size_type count = 0;
+            if (!count_sorted(first, last, verify, count)) return false;
+            if (empty()) return assign_sorted(first, last, false);
+            for (; first != last; ++first) insert(*first);
+            return true;
+        }
+
+        // _compare keys
+        bool isPreceding(const key_type &lhs, const key_type &rhs) const { return _compare(lhs, rhs); }
+        bool isSucceeding(const key_type &lhs, const key_type &rhs) const { return _compare(rhs, lhs); }
+        bool isEqual(const key_type &lhs, const key_type &rhs) const { return !_compare(lhs, rhs) && !_compare(rhs, lhs); }
+
+    private:
+        const_iterator position(const leaf_t *leaf, int pos) const {
+            if (pos < leaf->count) return const_iterator(leaf, pos, this);
+            return const_iterator(leaf->next, 0, this);
+        }
+        void steal(b_tree &other) {
+            _root = other._root; _first = other._first; _last = other._last;
+            _height = other._height; _size = other._size;
+            other._root = nullptr; other._first = other._last = nullptr;
+            other._height = 0; other._size = 0;
+        }
+
+        /**
+         * Count a range of items, and optionally verify, that keys are strictly increasing
+         * @return false if verify failed
+         */
+        template<class ForwardIt>
+        bool count_sorted(ForwardIt first, ForwardIt last, bool verify, size_type &count) const {
+            count = 0;
+            for (ForwardIt previous = first; first != last; previous = first, ++first, ++count)
+                if (verify && count && !isPreceding(extract_key(*previous), extract_key(*first)))
+                    return false;
+            return true;
+        }
+
+        // first item, that is not less than the key
+        int lower_bound_in_leaf(const leaf_t *leaf, const key_type &k) const {
+            int lo = 0, hi = leaf->count;
+            while (lo < hi) {
+                const int mid = (lo + hi) >> 1;
+                if (isPreceding(extract_key(leaf->items()[mid]), k)) lo = mid + 1;
+                else hi = mid;
+            }
+            return lo;
+        }
+        // first item, that is greater than the key
+        int upper_bound_in_leaf(const leaf_t *leaf, const key_type &k) const {
+            int lo = 0, hi = leaf->count;
+            while (lo < hi) {
+                const int mid = (lo + hi) >> 1;
+                if (isPreceding(k, extract_key(leaf->items()[mid]))) hi = mid;
+                else lo = mid + 1;
+            }
+            return lo;
+        }
+        // the child, that may hold the key, is the first child with a greater separator
+        int child_index(const inner_t *inner, const key_type &k) const {
+            int lo = 0, hi = inner->count - 1;
+            while (lo < hi) {
+                const int mid = (lo + hi) >> 1;
+                if (isPreceding(k, inner->keys()[mid])) hi = mid;
+                else lo = mid + 1;
+            }
+            return lo;
+        }
+        /**
+         * Descend to the leaf, that may hold a key
+         * @param k key
+         * @param path (Optional) records the inner nodes and the index of the child taken
+         * @param depth (Optional) count of recorded inner nodes
+         * @return the leaf or nullptr for empty tree
+         */
+        leaf_t *leaf_of(const key_type &k, path_t *path, int *depth) const {
+            node_t *node = _root;
+            for (int level = 0; node && level < _height; ++level) {
+                auto *inner = static_cast<inner_t *>(node);
+                const int index = child_index(inner, k);
+                if (path) path[(*depth)++] = { inner, index };
+                node = inner->children[index];
+            }
+            return static_cast<leaf_t *>(node);
+        }
+
+        // move items between non overlapping arrays, or down within the same array
+        static void move_items(StoreItemType *to, StoreItemType *from, int count) {
+            for (int ix = 0; ix < count; ++ix) {
+                ::new(to + ix, microc_new::blah) StoreItemType(microc::traits::move(from[ix]));
+                from[ix].~StoreItemType();
+            }
+        }
+        // shift items up within the same array
+        static void shift_items_up(StoreItemType *items, int from, int count, int by) {
+            for (int ix = count - 1; ix >= from; --ix) {
+                ::new(items + ix + by, microc_new::blah) StoreItemType(microc::traits::move(items[ix]));
+                items[ix].~StoreItemType();
+            }
+        }
+        static void move_key(key_type *to, key_type *from) {
+            ::new(to, microc_new::blah) key_type(microc::traits::move(*from));
+            from->~key_type();
+        }
+        void copy_key(key_type *to, const StoreItemType &item) {
+            ::new(to, microc_new::blah) key_type(extract_key(item));
+        }
+        // remove key at index and child at index + 1
+        static void erase_from_inner(inner_t *inner, int index) {
+            auto *keys = inner->keys();
+            keys[index].~key_type();
+            for (int ix = index; ix < inner->count - 2; ++ix) move_key(keys + ix, keys + ix + 1);
+            for (int ix = index + 1; ix < inner->count - 1; ++ix) inner->children[ix] = inner->children[ix + 1];
+            inner->count -= 1;
+        }
+
+        leaf_t *new_leaf() {
+            auto *leaf = _alloc.allocate(1);
+            leaf->count = 0;
+            leaf->prev = leaf->next = nullptr;
+            return leaf;
+        }
+        inner_t *new_inner() {
+            auto *inner = _inner_alloc.allocate(1);
+            inner->count = 0;
+            return inner;
+        }
+        void free_leaf(leaf_t *leaf) {
+            if (leaf->prev) leaf->prev->next = leaf->next; else _first = leaf->next;
+            if (leaf->next) leaf->next->prev = leaf->prev; else _last = leaf->prev;
+            _alloc.deallocate(leaf);
+        }
+        /**
+         * Insert an item
+         * @param item item
+         * @param has_succeeded True if the item was inserted. False, if the key is already present
+         * @param move_ctor move construct the item
+         * @return position of the new or the existing item
+         */
+        const_iterator insert_item(const StoreItemType &item, bool &has_succeeded, const bool move_ctor) {
+            if (_root == nullptr) _root = _first = _last = new_leaf();
+            path_t path[max_height];
+            int depth = 0;
+            const key_type &key = extract_key(item);
+            leaf_t *leaf = leaf_of(key, path, &depth);
+            int pos = lower_bound_in_leaf(leaf, key);
+            if (pos < leaf->count && !isPreceding(key, extract_key(leaf->items()[pos]))) {
+                has_succeeded = false;
+                return const_iterator(leaf, pos, this);
+            }
+            has_succeeded = true;
+            _size += 1;
+            leaf_t *target = leaf;
+            if (leaf->count == max_items) {
+                // split, the left keeps the lower half
+                leaf_t *right = new_leaf();
+                const int mid = (max_items + 1) / 2;
+                const int split_at = pos < mid ? mid - 1 : mid;
+                move_items(right->items(), leaf->items() + split_at, max_items - split_at);
+                right->count = max_items - split_at;
+                leaf->count = split_at;
+                right->next = leaf->next; right->prev = leaf;
+                if (leaf->next) leaf->next->prev = right; else _last = right;
+                leaf->next = right;
+                if (pos >= mid) { target = right; pos -= mid; }
+                insert_into_leaf(target, pos, item, move_ctor);
+                alignas(key_type) unsigned char separator[sizeof(key_type)];
+                copy_key(reinterpret_cast<key_type *>(separator), right->items()[0]);
+                insert_into_parents(path, depth, reinterpret_cast<key_type *>(separator), right);
+            } else insert_into_leaf(target, pos, item, move_ctor);
+            return const_iterator(target, pos, this);
+        }
+        void insert_into_leaf(leaf_t *leaf, int pos, const StoreItemType &item, const bool move_ctor) {
+            shift_items_up(leaf->items(), pos, leaf->count, 1);
+            if (move_ctor) ::new(leaf->items() + pos, microc_new::blah)
+                        StoreItemType(microc::traits::move(const_cast<StoreItemType &>(item)));
+            else ::new(leaf->items() + pos, microc_new::blah) StoreItemType(item);
+            leaf->count += 1;
+        }
+        /**
+         * Insert a separator and its right node into the parents, split full parents bottom up
+         * @param path inner nodes from the root down to the parent of the split node
+         * @param depth count of inner nodes in the path
+         * @param separator key, that is moved into the parent
+         * @param right the new node, to the right of the separator
+         */
+        void insert_into_parents(path_t path[], int depth, key_type *separator, node_t *right) {
+            while (depth--) {
+                inner_t *inner = path[depth].node;
+                const int index = path[depth].index;
+                auto *keys = inner->keys();
+                if (inner->count < max_items) {
+                    for (int ix = inner->count - 2; ix >= index; --ix) move_key(keys + ix + 1, keys + ix);
+                    for (int ix = inner->count - 1; ix > index; --ix) inner->children[ix + 1] = inner->children[ix];
+                    move_key(keys + index, separator);
+                    inner->children[index + 1] = right;
+                    inner->count += 1;
+                    return;
+                }
+                // split a full inner node of max_items + 1 children, the middle key goes up
+                alignas(key_type) unsigned char all_storage[sizeof(key_type) * Order];
+                node_t *all_children[Order + 1];
+                auto *all_keys = reinterpret_cast<key_type *>(all_storage);
+                for (int ix = 0, jx = 0; ix < max_items - 1; ++ix, ++jx) {
+                    if (jx == index) ++jx;
+                    move_key(all_keys + jx, keys + ix);
+                }
+                move_key(all_keys + index, separator);
+                for (int ix = 0, jx = 0; ix < max_items; ++ix, ++jx) {
+                    all_children[jx] = inner->children[ix];
+                    if (ix == index) all_children[++jx] = right;
+                }
+                const int left_count = (max_items + 1) / 2;
+                const int right_count = max_items + 1 - left_count;
+                inner_t *sibling = new_inner();
+                for (int ix = 0; ix < left_count - 1; ++ix) move_key(keys + ix, all_keys + ix);
+                for (int ix = 0; ix < left_count; ++ix) inner->children[ix] = all_children[ix];
+                move_key(separator, all_keys + left_count - 1);
+                for (int ix = 0; ix < right_count - 1; ++ix) move_key(sibling->keys() + ix, all_keys + left_count + ix);
+                for (int ix = 0; ix < right_count; ++ix) sibling->children[ix] = all_children[left_count + ix];
+                inner->count = left_count;
+                sibling->count = right_count;
+                right = sibling;
+            }
+            // the root was split, grow a new root
+            inner_t *root = new_inner();
+            root->children[0] = _root;
+            root->children[1] = right;
+            move_key(root->keys(), separator);
+            root->count = 2;
+            _root = root;
+            _height += 1;
+        }
+
+        /**
+         * Refill a leaf, that has too few items, from a sibling or merge it with a sibling
+         * @param leaf the leaf
+         * @param parent the parent of the leaf and the index of the leaf in it
+         * @param pos position in the leaf, that is tracked, updated to its new place
+         * @return the leaf, that holds the tracked position
+         */
+        leaf_t *re_balance_leaf(leaf_t *leaf, path_t parent, int &pos) {
+            inner_t *inner = parent.node;
+            const int index = parent.index;
+            auto *keys = inner->keys();
+            leaf_t *left = index > 0 ? static_cast<leaf_t *>(inner->children[index - 1]) : nullptr;
+            leaf_t *right = index + 1 < inner->count ? static_cast<leaf_t *>(inner->children[index + 1]) : nullptr;
+            if (left && left->count > min_leaf_items) {
+                shift_items_up(leaf->items(), 0, leaf->count, 1);
+                move_items(leaf->items(), left->items() + left->count - 1, 1);
+                left->count -= 1; leaf->count += 1; pos += 1;
+                keys[index - 1].~key_type();
+                copy_key(keys + index - 1, leaf->items()[0]);
+            } else if (right && right->count > min_leaf_items) {
+                move_items(leaf->items() + leaf->count, right->items(), 1);
+                move_items(right->items(), right->items() + 1, right->count - 1);
+                right->count -= 1; leaf->count += 1;
+                keys[index].~key_type();
+                copy_key(keys + index, right->items()[0]);
+            } else if (left) {
+                move_items(left->items() + left->count, leaf->items(), leaf->count);
+                pos += left->count;
+                left->count += leaf->count;
+                free_leaf(leaf);
+                erase_from_inner(inner, index - 1);
+                return left;
+            } else {
+                move_items(leaf->items() + leaf->count, right->items(), right->count);
+                leaf->count += right->count;
+                free_leaf(right);
+                erase_from_inner(inner, index);
+            }
+            return leaf;
+        }
+        /**
+         * Refill inner nodes, that have too few children, bottom up, and shrink the root
+         * @param path inner nodes from the root down, and the index of the child taken
+         * @param depth index of the lowest inner node, that may have too few children
+         */
+        void re_balance_path(path_t path[], int depth) {
+            for (; depth > 0; --depth) {
+                inner_t *node = path[depth].node;
+                if (node->count >= min_children) break;
+                inner_t *inner = path[depth - 1].node;
+                int index = path[depth - 1].index;
+                auto *keys = inner->keys();
+                inner_t *left = index > 0 ? static_cast<inner_t *>(inner->children[index - 1]) : nullptr;
+                inner_t *right = index + 1 < inner->count ? static_cast<inner_t *>(inner->children[index + 1]) : nullptr;
+                if (left && left->count > min_children) {
+                    // rotate right through the parent separator
+                    for (int ix = node->count - 2; ix >= 0; --ix) move_key(node->keys() + ix + 1, node->keys() + ix);
+                    for (int ix = node->count - 1; ix >= 0; --ix) node->children[ix + 1] = node->children[ix];
+                    move_key(node->keys(), keys + index - 1);
+                    node->children[0] = left->children[left->count - 1];
+                    move_key(keys + index - 1, left->keys() + left->count - 2);
+                    left->count -= 1; node->count += 1;
+                    break;
+                } else if (right && right->count > min_children) {
+                    // rotate left through the parent separator
+                    move_key(node->keys() + node->count - 1, keys + index);
+                    node->children[node->count] = right->children[0];
+                    move_key(keys + index, right->keys());
+                    for (int ix = 0; ix < right->count - 2; ++ix) move_key(right->keys() + ix, right->keys() + ix + 1);
+                    for (int ix = 0; ix < right->count - 1; ++ix) right->children[ix] = right->children[ix + 1];
+                    right->count -= 1; node->count += 1;
+                    break;
+                }
+                // merge with a sibling, the parent separator comes down between them
+                if (left) { right = node; node = left; }
+                else ++index;
+                move_key(node->keys() + node->count - 1, keys + index - 1);
+                for (int ix = 0; ix < right->count - 1; ++ix)
+                    move_key(node->keys() + node->count + ix, right->keys() + ix);
+                for (int ix = 0; ix < right->count; ++ix)
+                    node->children[node->count + ix] = right->children[ix];
+                node->count += right->count;
+                _inner_alloc.deallocate(right);
+                // the separator was moved out, close the gap
+                for (int ix = index - 1; ix < inner->count - 2; ++ix) move_key(keys + ix, keys + ix + 1);
+                for (int ix = index; ix < inner->count - 1; ++ix) inner->children[ix] = inner->children[ix + 1];
+                inner->count -= 1;
+            }
+            // shrink the root, while it has a single child
+            while (_height > 0 && _root->count == 1) {
+                auto *root = static_cast<inner_t *>(_root);
+                _root = root->children[0];
+                _inner_alloc.deallocate(root);
+                _height -= 1;
+            }
+        }
+    };
+
+    template<class StoreItemType, class Key, class Compare,
+            class KeyExtractFunction, class Allocator, unsigned Order>
+    bool operator==(const b_tree<StoreItemType, Key, Compare, KeyExtractFunction, Allocator, Order>& lhs,
+                    const b_tree<StoreItemType, Key, Compare, KeyExtractFunction, Allocator, Order>& rhs ) {
+        if(!(lhs.size()==rhs.size())) return false;
+        auto r = rhs.begin();
+        for (const auto & item : lhs) if(!(item==*(r++))) return false;
+        return true;
+    }
+
+    /**
+     * Selects a b_tree as the tree of dictionary and ordered_set
+     * @tparam Order max items of a leaf and max children of an inner node
+     */
+    template<unsigned Order=32>
+    struct b_tree_backend {
+        template<class StoreItemType, class Key, class Compare, class KeyExtractFunction, class Allocator>
+        using tree = b_tree<StoreItemType, Key, Compare, KeyExtractFunction, Allocator, Order>;
+    };
+}
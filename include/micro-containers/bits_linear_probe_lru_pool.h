@@ -10,6 +10,8 @@
 ========================================================================================*/
 #pragma once
 
+#include "lru_stats.h"
+
 namespace microc {
 #define LRU_PRINT_SEQ 0
 #define LRU_PRINT_ORDER_MRU 1
@@ -136,6 +138,9 @@ namespace microc {
         int _mru_size;
         const int _max_size;
         rebind_alloc _allocator;
+#ifdef LRU_CACHE_ENABLE_STATS
+        lru_stats _stats;
+#endif
 
         template<class tp> static tp min(const tp & a, const tp & b) { return a<b?a:b; }
         template<class tp> static tp max(const tp & a, const tp & b) { return a>b?a:b; }
@@ -169,6 +174,11 @@ namespace microc {
         constexpr int capacity() const { return items_count; }
         int size() const { return _mru_size; }
         int maxSize() const { return _max_size; }
+#ifdef LRU_CACHE_ENABLE_STATS
+        // snapshot of the counters
+        lru_stats stats() const { return _stats; }
+        void reset_stats() { _stats.reset(); }
+#endif
 
     private:
         inline int c2p(machine_word code) const {
@@ -250,6 +260,7 @@ namespace microc {
             auto & node = _items[pos];
             int removed_value = node.value();
             internal_remove_key_node(node, pos);
+            LRU_STATS_COUNT(++_stats.evictions)
             return removed_value;
         }
 
@@ -257,6 +268,7 @@ namespace microc {
         bool has(machine_word key) const { return internal_pos_of(key) + 1; }
         int get(machine_word key) {
             const auto pos = internal_pos_of(key);
+            LRU_STATS_COUNT(++(pos==-1 ? _stats.misses : _stats.hits))
             // report -1 if key not found
             if(pos==-1) return -1;
             auto & item = _items[pos];
@@ -270,7 +282,8 @@ namespace microc {
             int removed_value = adjust_load_factor_remove_one();
             auto start = c2p(key);
             int first_free_pos=-1;
-            for (int step = 0; step < items_count; ++step) {
+            int step = 0;
+            for (; step < items_count; ++step) {
                 auto pos = c2p(step+start); // modulo
                 item_t & item = _items[pos];
                 if (item.is_tombstone()) {
@@ -284,6 +297,7 @@ namespace microc {
                 } // important that this is first
                 if (item.key == key) { // found the item with high probability
                     move_attached_node_to_list_head(item, pos, _mru_list);
+                    LRU_STATS_COUNT(count_get_or_put(true, step))
                     return {item.value(), removed_value, true};
                 }
             }
@@ -298,10 +312,19 @@ namespace microc {
             remove_node(item, first_free_pos, _free_list);
             move_detached_node_to_list_head(item, first_free_pos, _mru_list);
             ++_mru_size;
+            LRU_STATS_COUNT(count_get_or_put(false, step))
             return { item.value(), removed_value, false };
         }
 
     private:
+#ifdef LRU_CACHE_ENABLE_STATS
+        void count_get_or_put(bool found, int probe_distance) {
+            if(found) ++_stats.hits;
+            else { ++_stats.misses; ++_stats.inserts; }
+            _stats.probe_distance += probe_distance;
+            ++_stats.probes;
+        }
+#endif
         void internal_remove_key_node(item_t & node, int start) {
             // we assume node is active
             remove_node(node, start, _mru_list);
@@ -317,6 +340,7 @@ namespace microc {
             auto & removed_item = _items[start];
             int removed_item_value = removed_item.value();
             internal_remove_key_node(removed_item, start);
+            LRU_STATS_COUNT(++_stats.removals)
             return removed_item_value;
         }
 
@@ -10,6 +10,10 @@
 ========================================================================================*/
 #pragma once
 
+#include "traits.h"
+#include "lru_stats.h"
+#include "lru_image.h"
+
 namespace microc {
 #define LRU_PRINT_SEQ 0
 #define LRU_PRINT_ORDER_MRU 1
@@ -18,6 +22,32 @@ namespace microc {
 
 #ifdef LRU_CACHE_ALLOW_PRINT
 #include <iostream>
+#endif
+// atomics for the single writer, multi reader path
+#ifndef LRU_LOAD
+#if defined(__GNUC__) || defined(__clang__)
+#define LRU_RELAXED __ATOMIC_RELAXED
+#define LRU_ACQUIRE __ATOMIC_ACQUIRE
+#define LRU_RELEASE __ATOMIC_RELEASE
+#define LRU_LOAD(variable, order) __atomic_load_n(&(variable), order)
+#define LRU_STORE(variable, value, order) __atomic_store_n(&(variable), value, order)
+#define LRU_FENCE(order) __atomic_thread_fence(order)
+#else
+#define LRU_RELAXED 0
+#define LRU_ACQUIRE 0
+#define LRU_RELEASE 0
+#define LRU_LOAD(variable, order) (*(volatile decltype(variable) *)&(variable))
+#define LRU_STORE(variable, value, order) ((*(volatile decltype(variable) *)&(variable)) = (value))
+#define LRU_FENCE(order)
+#endif
+#endif
+#define LRU_LOAD_RELAXED(variable) LRU_LOAD(variable, LRU_RELAXED)
+#ifndef LRU_PREFETCH
+#if defined(__GNUC__) || defined(__clang__)
+#define LRU_PREFETCH(address) __builtin_prefetch(address)
+#else
+#define LRU_PREFETCH(address)
+#endif
 #endif
     /**
      * LRU Cache and pool for integer values with constrained bits:
@@ -33,49 +63,93 @@ namespace microc {
      * - The size of the cache is a power of 2 of the bits for value, which gives some optimizations.
      * - perfect for small caches: up to 1024 entries for 32 bit keys and 2,097,152 for 64 bit keys.
      * - perfect for storing integer indices.
+     * - wide index layout lifts the size limit to 30 bits (1,073,741,824 entries), at the cost of
+     *   128 bit entries for 32 bits keys and 192 bit entries for 64 bits keys.
      *
      * @tparam size_bits the integer bits size
      * @tparam machine_word the machine word type = short, int or long
+     * @tparam wide_index use separate 32 bits value/prev/next fields instead of packing them in a machine word
      */
-    template<int size_bits=10, class machine_word=long, class Allocator=void>
+    template<int size_bits=10, class machine_word=long, class Allocator=void, bool wide_index=false>
     class bits_robin_lru_pool {
         using mw = machine_word;
+        using u32 = unsigned int;
         static constexpr int sb=size_bits;
         static constexpr int size_of_mw_bytes=sizeof (mw);
         static constexpr int size_of_mw_bits = size_of_mw_bytes<<3;
-        static constexpr int items_count = 1<<sb;
+        static constexpr int max_items_count = 1<<sb;
         static constexpr mw mm = (mw(1)<<sb)-1;
         static constexpr mw mask_payload = mm;
         static constexpr mw mask_prev = mm << sb;
         static constexpr mw mask_next = mm << (sb+sb);
         static constexpr mw mask_free = mw(1) << (size_of_mw_bits - 1);
+        static constexpr u32 wide_mask_free = u32(1) << 31;
         // data = LSB[...data... | ...prev... | ...next... | free ]MSB
         // data = MSB[ free | ...pad... | ...next... | ...prev... | ...data... ]LSB
-        struct item_t {
+        // key and data are read by concurrent readers (see value_of_concurrent), so the
+        // writer stores them with relaxed atomic stores
+        struct packed_item_t {
+            using data_type = machine_word;
             machine_word key;
             machine_word data;
 
-            inline int value() const { return data & mm; }
+            static int value_of_data(data_type d) { return d & mm; }
+            static bool is_free_data(data_type d) { return (d>>(size_of_mw_bits-1)) & mw(1); }
+            inline int value() const { return value_of_data(data); }
             inline int prev() const { return (data>>sb) & mm; }
             inline int next() const { return (data>>(sb<<1)) & mm; }
-            inline bool is_free() const { return (data>>(size_of_mw_bits-1)) & mw(1); }
+            inline bool is_free() const { return is_free_data(data); }
+            inline void set_key(machine_word value) { LRU_STORE(key, value, LRU_RELAXED); }
+            inline void set_data(data_type value) { LRU_STORE(data, value, LRU_RELAXED); }
             inline void set_value(int value) {
-                data = (data & (~mask_payload)) | mw(value & mm);
+                set_data((data & (~mask_payload)) | mw(value & mm));
             }
             inline void set_prev(int value) {
-                data = (data & (~mask_prev)) | (mw(value & mm) << sb);
+                set_data((data & (~mask_prev)) | (mw(value & mm) << sb));
             }
             inline void set_next(int value) {
-                data = (data & (~mask_next)) | (mw(value & mm) << (sb<<1));
+                set_data((data & (~mask_next)) | (mw(value & mm) << (sb<<1)));
+            }
+            inline void set_is_free_true() { set_data(data | mask_free); }
+            inline void set_is_free_false() { set_data(data & (~mask_free)); }
+            inline void assign(const packed_item_t & other) { set_key(other.key); set_data(other.data); }
+        };
+        // data = MSB[ free | ...data... ]LSB, prev and next get their own 32 bits
+        // readers do not read prev and next, so only key and data are stored atomically
+        struct wide_item_t {
+            using data_type = u32;
+            machine_word key;
+            u32 data;
+            u32 prev_idx, next_idx;
+
+            static int value_of_data(data_type d) { return int(d & u32(mm)); }
+            static bool is_free_data(data_type d) { return d & wide_mask_free; }
+            inline int value() const { return value_of_data(data); }
+            inline int prev() const { return int(prev_idx); }
+            inline int next() const { return int(next_idx); }
+            inline bool is_free() const { return is_free_data(data); }
+            inline void set_key(machine_word value) { LRU_STORE(key, value, LRU_RELAXED); }
+            inline void set_data(data_type value) { LRU_STORE(data, value, LRU_RELAXED); }
+            inline void set_value(int value) {
+                set_data((data & wide_mask_free) | (u32(value) & u32(mm)));
+            }
+            inline void set_prev(int value) { prev_idx = u32(value) & u32(mm); }
+            inline void set_next(int value) { next_idx = u32(value) & u32(mm); }
+            inline void set_is_free_true() { set_data(data | wide_mask_free); }
+            inline void set_is_free_false() { set_data(data & (~wide_mask_free)); }
+            inline void assign(const wide_item_t & other) {
+                set_key(other.key); set_data(other.data);
+                prev_idx = other.prev_idx; next_idx = other.next_idx;
             }
-            inline void set_is_free_true() { data = data | mask_free; }
-            inline void set_is_free_false() { data = data & (~mask_free); }
         };
+        using item_t = typename microc::traits::conditional<wide_index,
+                wide_item_t, packed_item_t>::type;
 
     public:
         using value_type = int;
         using allocator_type = Allocator;
         using rebind_alloc = typename allocator_type::template rebind<item_t>::other;
+        static constexpr unsigned long item_type_size = sizeof(item_t);
         struct result_type {
             // the value that was chosen
             int value;
@@ -83,6 +157,8 @@ namespace microc {
             int removed_value;
             // inserted key was active or free ?
             bool is_active;
+            // the key of the LRU item that became free, valid if removed_value is not -1
+            machine_word removed_key;
         };
 
         struct iterator_t {
@@ -127,12 +203,20 @@ namespace microc {
         item_t * _items;
         int _mru_list, _free_list;
         int _mru_size;
-        const int _max_size;
+        int _max_size;
+        int _items_count;
+        machine_word _home_mask;
+        float _load_factor;
+        // sequence of the single writer, odd while items are being moved
+        unsigned long _version;
         rebind_alloc _allocator;
+#ifdef LRU_CACHE_ENABLE_STATS
+        lru_stats _stats;
+#endif
 
         template<class tp> static tp min(const tp & a, const tp & b) { return a<b?a:b; }
         template<class tp> static tp max(const tp & a, const tp & b) { return a>b?a:b; }
-        static int compute_max_items(float load_factor) {
+        static int compute_max_items(float load_factor, int items_count) {
             load_factor = min(load_factor, 1.0f);
             int max_items = load_factor * items_count;
             // make sure one free spot is always available
@@ -140,45 +224,222 @@ namespace microc {
             max_items = max(max_items, 1);
             return max_items;
         }
+        static int clamp_capacity_bits(int capacity_bits) {
+            return max(min(capacity_bits, size_bits), 1);
+        }
 
     public:
 
         bits_robin_lru_pool(float load_factor=0.5f, const allocator_type & allocator = allocator_type()) :
+                            bits_robin_lru_pool(sb, load_factor, allocator) {}
+        /**
+         * construct a pool with a run-time capacity of 2^capacity_bits entries.
+         * size_bits is the maximal capacity bits, and it sets the layout of the item.
+         * @param capacity_bits capacity bits in [1, size_bits], out of range values are clamped
+         * @param load_factor the load factor
+         * @param allocator the allocator
+         */
+        bits_robin_lru_pool(int capacity_bits, float load_factor,
+                            const allocator_type & allocator = allocator_type()) :
                             _items(nullptr), _mru_list(-1), _free_list(-1), _mru_size(0),
-                            _max_size(compute_max_items(load_factor)), _allocator(allocator) {
-            constexpr bool correcto = (size_of_mw_bytes==4 and (size_bits>=1 and size_bits<=10)) or
+                            _max_size(0), _items_count(1<<clamp_capacity_bits(capacity_bits)),
+                            _home_mask(mw(_items_count)-1), _load_factor(load_factor),
+                            _version(0), _allocator(allocator) {
+            constexpr bool correcto = wide_index ? (size_bits>=1 and size_bits<=30) :
+                    (size_of_mw_bytes==4 and (size_bits>=1 and size_bits<=10)) or
                     (size_of_mw_bytes==8 and (size_bits>=1 and size_bits<=21));
             static_assert(correcto, "fail");
-            _items = _allocator.allocate(items_count);
+            _max_size = compute_max_items(load_factor, _items_count);
+            _items = _allocator.allocate(_items_count);
             // set linked list
             clear();
         }
         ~bits_robin_lru_pool() {
-            _allocator.deallocate(_items, items_count);
+            if(_items) _allocator.deallocate(_items, _items_count);
             _items= nullptr;
         }
 
         allocator_type get_allocator() { return _allocator; }
 
-        constexpr int capacity() const { return items_count; }
+        int capacity() const { return _items_count; }
+        static constexpr int maxCapacity() { return max_items_count; }
         int size() const { return _mru_size; }
         int maxSize() const { return _max_size; }
+        float loadFactor() const { return _load_factor; }
+#ifdef LRU_CACHE_ENABLE_STATS
+        // snapshot of the counters
+        lru_stats stats() const { return _stats; }
+        void reset_stats() { _stats.reset(); }
+#endif
+
+        // swaps the contents, allocators are assumed to be equal, and counters stay
+        void swap(bits_robin_lru_pool & other) noexcept {
+            item_t * items = _items; _items = other._items; other._items = items;
+            int ii = _mru_list; _mru_list = other._mru_list; other._mru_list = ii;
+            ii = _free_list; _free_list = other._free_list; other._free_list = ii;
+            ii = _mru_size; _mru_size = other._mru_size; other._mru_size = ii;
+            ii = _max_size; _max_size = other._max_size; other._max_size = ii;
+            ii = _items_count; _items_count = other._items_count; other._items_count = ii;
+            machine_word mask = _home_mask; _home_mask = other._home_mask; other._home_mask = mask;
+            float lf = _load_factor; _load_factor = other._load_factor; other._load_factor = lf;
+        }
+
+        /**
+         * the least recently used item, iterating with -- goes towards the most recently used
+         */
+        const_iterator lru() const noexcept {
+            return const_iterator(_mru_list==-1 ? -1 : _items[_mru_list].prev(), this);
+        }
+
+        // size in bytes of the image of the pool
+        unsigned long serialized_size() const {
+            return lru_image::aligned(sizeof(lru_image::pool_header)) +
+                   lru_image::aligned(sizeof(item_t) * _items_count);
+        }
+        /**
+         * write a binary image of the pool, which keeps the contents and the recency order.
+         * items and list heads are indices, so the image is position independent.
+         * @param image destination memory, better aligned to lru_image::alignment
+         * @param size size of the destination in bytes
+         * @return bytes written, or 0 if the destination is too small
+         */
+        unsigned long serialize(void * image, unsigned long size) const {
+            const unsigned long needed = serialized_size();
+            if(size < needed) return 0;
+            lru_image::pool_header header;
+            header.magic = lru_image::pool_magic;
+            header.version = lru_image::version;
+            header.item_size = sizeof(item_t);
+            header.size_bits = size_bits;
+            header.capacity = _items_count;
+            header.max_size = _max_size;
+            header.mru_list = _mru_list;
+            header.free_list = _free_list;
+            header.mru_size = _mru_size;
+            header.load_factor = _load_factor;
+            auto * bytes = static_cast<unsigned char *>(image);
+            lru_image::copy_bytes(bytes, &header, sizeof(header));
+            lru_image::copy_bytes(bytes + lru_image::aligned(sizeof(header)), _items,
+                                  sizeof(item_t) * _items_count);
+            return needed;
+        }
+        /**
+         * restore the pool from an image, that was written by a pool of the same type.
+         * The run-time capacity of the image is adopted, this is a bulk copy of the items.
+         * @param image source memory, for example an mmap'd file
+         * @param size size of the source in bytes
+         * @return bytes read, or 0 if the image is incompatible or corrupt, in which case the pool
+         *         is untouched. An image is corrupt if its sizes are out of range, or if its LRU
+         *         and free lists are not closed rings of the sizes, with links and values in range
+         */
+        unsigned long deserialize(const void * image, unsigned long size) {
+            const auto * bytes = static_cast<const unsigned char *>(image);
+            const unsigned long header_size = lru_image::aligned(sizeof(lru_image::pool_header));
+            if(size < header_size) return 0;
+            lru_image::pool_header header;
+            lru_image::copy_bytes(&header, bytes, sizeof(header));
+            const bool compatible = header.magic==lru_image::pool_magic &&
+                    header.version==lru_image::version && header.item_size==sizeof(item_t) &&
+                    header.size_bits==size_bits && header.capacity>=2 &&
+                    header.capacity<=max_items_count && !(header.capacity & (header.capacity-1));
+            if(!compatible) return 0;
+            // the list heads and sizes are used as indices, a corrupt image is rejected.
+            // a full pool holds max_size+1 items, the excess one is evicted by the next put
+            const bool consistent = header.mru_list>=-1 && header.mru_list<header.capacity &&
+                    header.free_list>=-1 && header.free_list<header.capacity &&
+                    header.mru_size>=0 && header.mru_size<=header.max_size+1 &&
+                    header.mru_size<=header.capacity && header.max_size<=header.capacity &&
+                    (header.mru_size==0)==(header.mru_list==-1) &&
+                    (header.mru_size==header.capacity)==(header.free_list==-1);
+            if(!consistent) return 0;
+            const unsigned long needed = header_size +
+                    lru_image::aligned(sizeof(item_t) * header.capacity);
+            if(size < needed) return 0;
+            const unsigned char * items = bytes + header_size;
+            if(!is_image_list_valid(items, header.capacity, header.mru_list, header.mru_size, false) ||
+               !is_image_list_valid(items, header.capacity, header.free_list,
+                                    header.capacity - header.mru_size, true))
+                return 0;
+            if(header.capacity != _items_count) {
+                _allocator.deallocate(_items, _items_count);
+                _items_count = header.capacity;
+                _home_mask = mw(_items_count)-1;
+                _items = _allocator.allocate(_items_count);
+            }
+            lru_image::copy_bytes(_items, bytes + header_size, sizeof(item_t) * _items_count);
+            _max_size = header.max_size;
+            _mru_list = header.mru_list;
+            _free_list = header.free_list;
+            _mru_size = header.mru_size;
+            _load_factor = header.load_factor;
+            return needed;
+        }
 
     private:
+        /**
+         * check a list of the items of an image, before they are copied
+         * @return true if the list is a ring of count items, that starts at head, with the
+         *         free bit, values and links in range of the capacity, and prev links, that
+         *         agree with the next links, so no item is visited twice
+         */
+        static bool is_image_list_valid(const unsigned char * items, int capacity, int head,
+                                        int count, bool free) {
+            if(count==0) return true;
+            item_t item;
+            int pos = head;
+            for (int ix = 0; ix < count; ++ix) {
+                lru_image::copy_bytes(&item, items + sizeof(item_t) * pos, sizeof(item_t));
+                const int next = item.next();
+                if(item.is_free()!=free || item.value()>=capacity || next>=capacity ||
+                   item.prev()>=capacity) return false;
+                // the ring closes at the head after count items, and not before
+                if((next==head)!=(ix==count-1)) return false;
+                item_t next_item;
+                lru_image::copy_bytes(&next_item, items + sizeof(item_t) * next, sizeof(item_t));
+                if(next_item.prev()!=pos) return false;
+                pos = next;
+            }
+            return true;
+        }
+
+        // a write section makes the version odd, readers retry if the version is odd
+        // or has changed during their read
+        void begin_write() {
+            LRU_STORE(_version, _version+1, LRU_RELAXED);
+            LRU_FENCE(LRU_RELEASE);
+        }
+        void end_write() { LRU_STORE(_version, _version+1, LRU_RELEASE); }
+        unsigned long begin_read() const {
+            unsigned long version;
+            while((version = LRU_LOAD(_version, LRU_ACQUIRE)) & 1ul);
+            return version;
+        }
+        bool end_read(unsigned long version) const {
+            LRU_FENCE(LRU_ACQUIRE);
+            return LRU_LOAD(_version, LRU_RELAXED) == version;
+        }
+#ifdef LRU_CACHE_ENABLE_STATS
+        void count_get_or_put(bool found, int probe_distance) {
+            if(found) ++_stats.hits;
+            else { ++_stats.misses; ++_stats.inserts; }
+            _stats.probe_distance += probe_distance;
+            ++_stats.probes;
+        }
+#endif
         inline int c2p(machine_word code) const {
             // when size is power of 2, we can get_or_put modulo with
             // bit-wise operation
-            return (code & mm);
+            return (code & _home_mask);
         }
 
         inline int distance_to_home_of(machine_word code, int current_home) const {
             // this is to avoid branching due to current home wrapping around
-            return c2p((current_home - c2p(code)) + items_count);
+            return c2p((current_home - c2p(code)) + _items_count);
         }
 
         int internal_pos_of(machine_word key) const {
             auto start = c2p(key);
-            for (int step = 0; step < items_count; ++step) {
+            for (int step = 0; step < _items_count; ++step) {
                 auto pos = c2p(step+start); // modulo
                 const auto & item = _items[pos];
                 if (item.is_free()) return -1; // important that this is first
@@ -230,23 +491,50 @@ namespace microc {
             }
         }
 
+        /**
+         * place a detached copy of an active item at slot `to`, and point its LRU list
+         * neighbours to it. The item keeps its place in the list.
+         * @param item the copy, its links are up to date, except that they may point to `to`,
+         *        which means the item, that is copied out of `to`
+         * @param is_head was the item the head of the LRU list
+         * @param to the destination slot
+         * @param displaced the copy of the item, that left `to`, or nullptr if `to` was free
+         */
+        void land_displaced_item(item_t & item, bool is_head, int to, item_t * displaced) {
+            if(_mru_size==1) { // the only item, it links to itself
+                item.set_prev(to);
+                item.set_next(to);
+            } else {
+                const auto prev = item.prev();
+                const auto next = item.next();
+                if(displaced && prev==to) displaced->set_next(to);
+                else _items[prev].set_next(to);
+                if(displaced && next==to) displaced->set_prev(to);
+                else _items[next].set_prev(to);
+            }
+            _items[to].assign(item);
+            if(is_head) _mru_list = to;
+        }
+
         void swap_detached_items(item_t & a, item_t & b) {
             // note: items have to be detached
-            item_t c = a;
-            a=b; b=c;
+            const item_t c = a;
+            a.assign(b); b.assign(c);
         }
 
         /**
          * remove just one excess item and return the int value, that
          * became free
          */
-        int adjust_load_factor_remove_one() {
+        int adjust_load_factor_remove_one(machine_word & removed_key) {
             int delta = _mru_size - _max_size;
             if(delta<=0) return -1;
             const auto pos = _items[_mru_list].prev(); // tail is LRU
             auto & node = _items[pos];
             int removed_value = node.value();
+            removed_key = node.key;
             internal_remove_key_node(node, pos);
+            LRU_STATS_COUNT(++_stats.evictions)
             return removed_value;
         }
         void adjust_load_factor() {
@@ -269,13 +557,41 @@ namespace microc {
          * @param key
          * @return
          */
-        int value_of(machine_word key) {
+        int value_of(machine_word key) const {
             const auto pos = internal_pos_of(key);
             return pos>=0 ? _items[pos].value() : -1;
         }
+        /**
+         * value_of, that may run in reader threads concurrently with a single writer thread,
+         * which calls the other methods. Readers never block the writer, a reader retries
+         * if the writer moved items while it was probing (seqlock). The writer stores keys
+         * and item words with relaxed atomic stores, and a hit re-links the LRU list outside
+         * of a write section, which never changes the key, value or free bit of an item.
+         * swap(), deserialize() and destruction are not allowed while readers are running.
+         */
+        int value_of_concurrent(machine_word key) const {
+            unsigned long version;
+            int value;
+            do {
+                version = begin_read();
+                value = -1;
+                const auto start = c2p(key);
+                for (int step = 0; step < _items_count; ++step) {
+                    const auto pos = c2p(start + step); // modulo
+                    const machine_word item_key = LRU_LOAD_RELAXED(_items[pos].key);
+                    const typename item_t::data_type data = LRU_LOAD_RELAXED(_items[pos].data);
+                    if (item_t::is_free_data(data)) break;
+                    if (item_key == key) { value = item_t::value_of_data(data); break; }
+                    if (distance_to_home_of(item_key, pos) < step) break;
+                }
+            } while(!end_read(version));
+            return value;
+        }
+        bool has_concurrent(machine_word key) const { return value_of_concurrent(key) + 1; }
 
         int get(machine_word key) {
             const auto pos = internal_pos_of(key);
+            LRU_STATS_COUNT(++(pos==-1 ? _stats.misses : _stats.hits))
             // report -1 if key not found
             if(pos==-1) return -1;
             auto & item = _items[pos];
@@ -292,107 +608,134 @@ namespace microc {
          * @return
          */
         result_type get_or_put(machine_word key) {
-            int removed_value = adjust_load_factor_remove_one();
+            machine_word removed_key = 0;
+            int removed_value = adjust_load_factor_remove_one(removed_key);
             auto start = c2p(key);
-            item_t next_displaced_item {};
-            int base_dist_of_displaced=0;
             int first_pos_to_displace = -1;
+            int base_dist_of_displaced=0;
             // first iterations to find a spot
-            for (int step = 0; step < items_count; ++step) {
+            for (int step = 0; step < _items_count; ++step) {
                 const auto pos = c2p(start + step); // modulo
                 item_t & item = _items[pos];
                 if (item.is_free()) {
                     // didn't find the key, let's take a free one instead.
-                    item.key = key;
+                    begin_write();
+                    item.set_key(key);
                     item.set_is_free_false();
+                    end_write();
                     remove_node(item, pos, _free_list);
                     move_detached_node_to_list_head(item, pos, _mru_list);
                     ++_mru_size;
-                    return { item.value(), removed_value, false };
+                    LRU_STATS_COUNT(count_get_or_put(false, step))
+                    return { item.value(), removed_value, false, removed_key };
                 }
                 if (item.key == key) { // found the key, let's return it
                     move_attached_node_to_list_head(item, pos, _mru_list);
-                    return { item.value(), removed_value, true };
+                    LRU_STATS_COUNT(count_get_or_put(true, step))
+                    return { item.value(), removed_value, true, removed_key };
                 }
                 base_dist_of_displaced = distance_to_home_of(item.key, pos);
                 if (base_dist_of_displaced < step) {
                     // early stop detection, the key is not present if we hit this condition.
-                    // lets robin hood steal from this place and use a new free item.
+                    // lets robin hood steal from this place, the key is inserted here at the end.
                     first_pos_to_displace = pos;
-                    // swap
-                    next_displaced_item = item;
-                    // no need to set value yet, only at the end.
-                    item.key = key;
-                    // we postpone the value to the first free item found during
-                    // the upcoming forward pass
-                    // move to head
-                    move_attached_node_to_list_head(item, pos, _mru_list);
-                    // next displaced item start pos
-                    start = pos;
-                    ++_mru_size;
+                    LRU_STATS_COUNT(count_get_or_put(false, step))
                     break;
                 }
             }
-            // now displacements, this is not in the above loop because lru cache
-            // requires some mods. NONE of the displaced items can be heads.
-            bool has_pending_displace=true;
-            while(has_pending_displace) {
-                has_pending_displace=false;
-                for (int step = 1; step < items_count; ++step) {
-                    const auto pos = c2p(start + step); // modulo
-                    auto & item = _items[pos];
-                    if (item.is_free()) { // free item, let's conquer
-                        remove_node(item, pos, _free_list);
-                        // we take the value of this free node and put it in the first
-                        // node that initiated the first displace
-                        const int value = item.value();
-                        _items[first_pos_to_displace].set_value(value);
-                        // override with previously displaced item
-                        item = next_displaced_item;
-                        insert_detached_node_before(item, pos, item.next(), _mru_list);
-                        // finished back-shift, let's return;
-                        return { value, removed_value, false };
-                    }
-                    int item_dist = distance_to_home_of(item.key, pos);
-                    if (item_dist < base_dist_of_displaced + step) { // let's robin hood
-                        // before all, current displaced item might have wanted to move
-                        // to one of its siblings(prev/next), so make a copy and update them.
-                        const auto temp = next_displaced_item;
-                        next_displaced_item = item;
-                        if(temp.next() == pos) next_displaced_item.set_prev(pos);
-                        if(temp.prev() == pos) next_displaced_item.set_next(pos);
-                        // now, detach current node
-                        remove_node(item, pos, _mru_list);
-                        // assign displaced
-                        item = temp;
-                        // update lru linked list, only change its siblings
-                        insert_detached_node_before(item, pos, item.next(), _mru_list);
-                        // prepare for next iteration
-                        base_dist_of_displaced = item_dist;
-                        start = pos;
-                        has_pending_displace=true;
-                        break;
-                    }
+            if(first_pos_to_displace==-1) return { -1, -1, false, 0 };
+            begin_write();
+            // now displacements, the displaced item is carried as a detached copy, that keeps its
+            // place in the LRU list, until it lands in a poorer or free slot, so the list order
+            // is never touched. The key gets the value of the free slot at the end of the chain.
+            start = first_pos_to_displace;
+            item_t displaced = _items[start];
+            bool displaced_is_head = start == _mru_list;
+            for (int step = 1; step < _items_count; ++step) {
+                const auto pos = c2p(start + step); // modulo
+                auto & item = _items[pos];
+                if (item.is_free()) { // free item, let's conquer
+                    remove_node(item, pos, _free_list);
+                    const int value = item.value();
+                    land_displaced_item(displaced, displaced_is_head, pos, nullptr);
+                    auto & inserted = _items[first_pos_to_displace];
+                    inserted.set_key(key);
+                    inserted.set_value(value);
+                    move_detached_node_to_list_head(inserted, first_pos_to_displace, _mru_list);
+                    ++_mru_size;
+                    end_write();
+                    return { value, removed_value, false, removed_key };
                 }
+                const int item_dist = distance_to_home_of(item.key, pos);
+                if (item_dist < base_dist_of_displaced + step) { // let's robin hood
+                    item_t next_displaced = item;
+                    const bool next_displaced_is_head = pos == _mru_list;
+                    land_displaced_item(displaced, displaced_is_head, pos, &next_displaced);
+                    displaced = next_displaced;
+                    displaced_is_head = next_displaced_is_head;
+                    // prepare for next iteration
+                    base_dist_of_displaced = item_dist;
+                    start = pos;
+                    step = 0;
+                }
+            }
+            end_write();
+            return { -1, -1, false, 0 };
+        }
+
+        /**
+         * get_or_put a batch of keys, the home slots of upcoming keys are prefetched while
+         * the current key is probed, so the cache misses into the items overlap.
+         * Results are the same as calling get_or_put for each key in order, therefore, if
+         * the batch is larger than maxSize(), values of early keys might be handed again
+         * to later keys in the batch.
+         * @param keys the keys
+         * @param count count of keys
+         * @param results output array of count results
+         */
+        void get_or_put_batch(const machine_word * keys, int count, result_type * results) {
+            const int ahead = count < batch_prefetch_distance ? count : batch_prefetch_distance;
+            for (int ix = 0; ix < ahead; ++ix) prefetch_home_of(keys[ix]);
+            for (int ix = 0; ix < count; ++ix) {
+                if(ix + ahead < count) prefetch_home_of(keys[ix + ahead]);
+                results[ix] = get_or_put(keys[ix]);
+            }
+        }
+        /**
+         * get a batch of keys with prefetching, same as calling get for each key in order
+         * @param keys the keys
+         * @param count count of keys
+         * @param values output array of count values, -1 for missing keys
+         */
+        void get_batch(const machine_word * keys, int count, int * values) {
+            const int ahead = count < batch_prefetch_distance ? count : batch_prefetch_distance;
+            for (int ix = 0; ix < ahead; ++ix) prefetch_home_of(keys[ix]);
+            for (int ix = 0; ix < count; ++ix) {
+                if(ix + ahead < count) prefetch_home_of(keys[ix + ahead]);
+                values[ix] = get(keys[ix]);
             }
-            return { -1, -1, false };
         }
 
     private:
+        // how many keys ahead are prefetched in the batch calls
+        static constexpr int batch_prefetch_distance = 8;
+        void prefetch_home_of(machine_word key) const { LRU_PREFETCH(_items + c2p(key)); }
+
         void internal_remove_key_node(item_t & node, int start) {
+            begin_write();
             remove_node(node, start, _mru_list);
             node.set_is_free_true();
             move_detached_node_to_list_head(node, start, _free_list);
             --_mru_size;
             ++start;
             // begin back shifting procedure
-            for (int step = 0; step < items_count; ++step) {
+            for (int step = 0; step < _items_count; ++step) {
                 auto pos = c2p(start + step); // modulo
                 auto & item = _items[pos];
                 // we are done when the item in question is free or it's distance
                 // from home is 0
-                if(item.is_free()) return;
-                if(distance_to_home_of(item.key, pos) == 0) return;
+                if(item.is_free()) break;
+                if(distance_to_home_of(item.key, pos) == 0) break;
                 // other-wise, we need to move it left because it's left sibling is empty
                 const auto pos_predecessor = c2p(start + step - 1); // modulo
                 auto & predecessor = _items[pos_predecessor];
@@ -408,6 +751,7 @@ namespace microc {
                 // the order of free items is not important
                 move_detached_node_to_list_head(item, pos, _free_list);
             }
+            end_write();
         }
 
     public:
@@ -422,13 +766,31 @@ namespace microc {
             auto & removed_item = _items[start];
             int removed_item_value = removed_item.value();
             internal_remove_key_node(removed_item, start);
+            LRU_STATS_COUNT(++_stats.removals)
             return removed_item_value;
         }
 
+        /**
+         * removes the least recently used item and returns its value
+         * @param removed_key (Optional) receives the key of the removed item
+         * @return the value, that became free, or -1 if the pool is empty
+         */
+        int remove_lru(machine_word * removed_key=nullptr) {
+            if(_mru_list==-1) return -1;
+            const auto pos = _items[_mru_list].prev(); // tail is LRU
+            auto & node = _items[pos];
+            int removed_value = node.value();
+            if(removed_key) *removed_key = node.key;
+            internal_remove_key_node(node, pos);
+            LRU_STATS_COUNT(++_stats.evictions)
+            return removed_value;
+        }
+
         void clear() {
-            for (int ix = 0; ix < items_count; ++ix) {
+            begin_write();
+            for (int ix = 0; ix < _items_count; ++ix) {
                 auto & item = _items[ix];
-                item.key=0;
+                item.set_key(0);
                 item.set_value(ix);
                 item.set_prev(ix-1);
                 item.set_next(ix+1);
@@ -438,8 +800,9 @@ namespace microc {
             _mru_size=0;
             _mru_list=-1;
             _free_list=0;
-            _items[items_count-1].set_next(_free_list);
-            _items[_free_list].set_prev(items_count-1);
+            _items[_items_count-1].set_next(_free_list);
+            _items[_free_list].set_prev(_items_count-1);
+            end_write();
         }
 
     void print(char order=1, int how_many=-1) const {
@@ -448,7 +811,7 @@ namespace microc {
             const bool order_mru = order==LRU_PRINT_ORDER_MRU;
             const bool order_free = order==LRU_PRINT_ORDER_FREE_LIST;
             int start = order_seq ? 0 : order_mru ? _mru_list : _free_list;
-            int stop = order_seq ? items_count : order_mru ? _mru_list : _free_list;
+            int stop = order_seq ? _items_count : order_mru ? _mru_list : _free_list;
             const char * str_order = order_seq ? "SEQUENCE" : order_mru ? "MRU" : "FREE";
             std::cout << "\n====== Printing in " << str_order << " order \n"
                       << "- LRU head is " << _mru_list << ", free head is "
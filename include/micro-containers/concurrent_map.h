@@ -0,0 +1,126 @@
+/*========================================================================================
+ Copyright (2021), Tomer Shalev (tomer.shalev@gmail.com, https://github.com/HendrixString).
+ All Rights Reserved.
+ License is a custom open source semi-permissive license with the following guidelines:
+ 1. unless otherwise stated, derivative work and usage of this file is permitted and
+    should be credited to the project and the author of this project.
+ 2. Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+========================================================================================*/
+#pragma once
+
+#include "concurrent_skip_list.h"
+#include "pair.h"
+
+namespace microc {
+    template<class Key>
+    struct concurrent_map_less {
+        bool operator()(const Key& lhs, const Key& rhs) const
+        {return lhs < rhs;}
+    };
+
+    //#define MICRO_CONTAINERS_ENABLE_THROW
+    #ifdef MICRO_CONTAINERS_ENABLE_THROW
+    struct throw_concurrent_map_out_of_range {};
+    #endif
+
+    template<class Key, class T>
+    struct concurrent_map_key_extract {
+        const Key & operator()(const pair<Key, T> &whole) const { return whole.first; }
+    };
+
+    /**
+     * Concurrent Map is an ordered map, that many threads insert to, erase from, search and
+     * iterate at the same time, over a lock free concurrent_skip_list.
+     * Notes:
+     * - find, contains, lower_bound, insert, erase and iteration are safe concurrently
+     * - a mapped value is set once by insert, and read only after, to change it, erase the key
+     *   and insert it again, or store a value, that synchronizes itself
+     * - erased items are freed by reclaim(), clear() or the destructor, which are not safe
+     *   concurrently with any other access (see concurrent_skip_list)
+     * - iterators are forward and const, dereferencing gives const pair<Key, T> &, they stay
+     *   valid until reclaim()
+     * - This class is Allocator-Aware, the Allocator must be thread safe
+     * @tparam Key the key type
+     * @tparam T The mapped value type of a item
+     * @tparam Compare compare structure or lambda for keys
+     * @tparam Allocator allocator type
+     */
+    template<class Key, class T,
+             class Compare=concurrent_map_less<Key>,
+             class Allocator=microc::std_allocator<char>>
+    class concurrent_map {
+    public:
+        using key_type = Key;
+        using mapped_type = T;
+        using value_type = pair<Key, T>;
+        using key_compare = Compare;
+        using size_type = microc::size_t;
+        using allocator_type = Allocator;
+        using reference = const value_type &;
+        using const_reference = const value_type &;
+        using list_type = concurrent_skip_list<value_type, Key, Compare, concurrent_map_key_extract<Key, T>, Allocator>;
+        using iterator = typename list_type::const_iterator;
+        using const_iterator = typename list_type::const_iterator;
+
+    private:
+        list_type _list;
+
+    public:
+        explicit concurrent_map(const Compare & comp,
+                                const Allocator & allocator=Allocator()) : _list(comp, allocator) {}
+        explicit concurrent_map(const Allocator & allocator=Allocator()) :
+                concurrent_map(Compare(), allocator) {};
+        concurrent_map(const concurrent_map &) = delete;
+        concurrent_map & operator=(const concurrent_map &) = delete;
+
+        Allocator get_allocator() const { return _list.get_allocator(); }
+        key_compare key_comp() const { return _list.get_comparator(); }
+
+        // iterators
+        const_iterator begin() const noexcept { return _list.begin(); }
+        const_iterator cbegin() const noexcept { return begin(); }
+        const_iterator end() const noexcept { return _list.end(); }
+        const_iterator cend() const noexcept { return end(); }
+
+        // capacity, size is exact when no thread modifies the map
+        bool empty() const noexcept { return _list.empty(); }
+        size_type size() const noexcept { return _list.size(); }
+
+        // lookup
+        const_iterator find(const Key& key) const { return _list.find(key); }
+        bool contains(const Key& key) const { return _list.contains(key); }
+        // first item, that is not less than the key
+        const_iterator lower_bound(const Key& key) const { return _list.lower_bound(key); }
+
+        // Element Access
+        const T& at(const Key& key) const {
+            auto iter = find(key);
+    #ifdef MICRO_CONTAINERS_ENABLE_THROW
+            if(iter==end()) throw throw_concurrent_map_out_of_range();
+    #endif
+            return (*iter).second;
+        }
+
+        // Modifiers, insert does not replace the value of an existing key
+        pair<iterator, bool> insert(const value_type& value) {
+            auto result = _list.insert(value);
+            return pair<iterator, bool>(result.first, result.second);
+        }
+        pair<iterator, bool> insert(value_type && value) {
+            auto result = _list.insert(microc::traits::move(value));
+            return pair<iterator, bool>(result.first, result.second);
+        }
+        template<class... Args>
+        pair<iterator, bool> emplace(Args &&... args) {
+            auto result = _list.insert_emplace(microc::traits::forward<Args>(args)...);
+            return pair<iterator, bool>(result.first, result.second);
+        }
+        // returns 1 if this call erased the key
+        unsigned erase(const Key& key) { return _list.remove_by_key(key) ? 1 : 0; }
+        // not safe concurrently with any other access
+        size_type reclaim() { return _list.reclaim(); }
+        void clear() { _list.clear(); }
+    };
+}
@@ -0,0 +1,104 @@
+/*========================================================================================
+ Copyright (2021), Tomer Shalev (tomer.shalev@gmail.com, https://github.com/HendrixString).
+ All Rights Reserved.
+ License is a custom open source semi-permissive license with the following guidelines:
+ 1. unless otherwise stated, derivative work and usage of this file is permitted and
+    should be credited to the project and the author of this project.
+ 2. Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+========================================================================================*/
+#pragma once
+
+#include "concurrent_skip_list.h"
+#include "pair.h"
+
+namespace microc {
+    template<class Key>
+    struct concurrent_set_less {
+        bool operator()(const Key& lhs, const Key& rhs) const
+        {return lhs < rhs;}
+    };
+
+    /**
+     * Concurrent Set is an ordered set, that many threads insert to, erase from, search and
+     * iterate at the same time, over a lock free concurrent_skip_list.
+     * Notes:
+     * - find, contains, lower_bound, insert, erase and iteration are safe concurrently
+     * - erased keys are freed by reclaim(), clear() or the destructor, which are not safe
+     *   concurrently with any other access (see concurrent_skip_list)
+     * - iterators are forward and const, they stay valid until reclaim()
+     * - This class is Allocator-Aware, the Allocator must be thread safe
+     * @tparam Key the item type, that the set stores
+     * @tparam Compare compare structure or lambda for item
+     * @tparam Allocator allocator type
+     */
+    template<class Key,
+             class Compare=concurrent_set_less<Key>,
+             class Allocator=microc::std_allocator<char>>
+    class concurrent_set {
+    public:
+        using key_type = Key;
+        using value_type = Key;
+        using size_type = microc::size_t;
+        using key_compare = Compare;
+        using value_compare = Compare;
+        using allocator_type = Allocator;
+        using reference = const value_type &;
+        using const_reference = const value_type &;
+        using list_type = concurrent_skip_list<Key, Key, Compare, skip_list_key_extract<Key, Key>, Allocator>;
+        using iterator = typename list_type::const_iterator;
+        using const_iterator = typename list_type::const_iterator;
+
+    private:
+        list_type _list;
+
+    public:
+        explicit concurrent_set(const Compare & comp,
+                                const Allocator & allocator=Allocator()) : _list(comp, allocator) {}
+        explicit concurrent_set(const Allocator & allocator=Allocator()) :
+                concurrent_set(Compare(), allocator) {};
+        concurrent_set(const concurrent_set &) = delete;
+        concurrent_set & operator=(const concurrent_set &) = delete;
+
+        Allocator get_allocator() const { return _list.get_allocator(); }
+        key_compare key_comp() const { return _list.get_comparator(); }
+        value_compare value_comp() const { return _list.get_comparator(); }
+
+        // iterators
+        const_iterator begin() const noexcept { return _list.begin(); }
+        const_iterator cbegin() const noexcept { return begin(); }
+        const_iterator end() const noexcept { return _list.end(); }
+        const_iterator cend() const noexcept { return end(); }
+
+        // capacity, size is exact when no thread modifies the set
+        bool empty() const noexcept { return _list.empty(); }
+        size_type size() const noexcept { return _list.size(); }
+
+        // lookup
+        const_iterator find(const Key& key) const { return _list.find(key); }
+        bool contains(const Key& key) const { return _list.contains(key); }
+        // first key, that is not less than the key
+        const_iterator lower_bound(const Key& key) const { return _list.lower_bound(key); }
+
+        // Modifiers
+        pair<iterator, bool> insert(const value_type& value) {
+            auto result = _list.insert(value);
+            return pair<iterator, bool>(result.first, result.second);
+        }
+        pair<iterator, bool> insert(value_type && value) {
+            auto result = _list.insert(microc::traits::move(value));
+            return pair<iterator, bool>(result.first, result.second);
+        }
+        template<class... Args>
+        pair<iterator, bool> emplace(Args &&... args) {
+            auto result = _list.insert_emplace(microc::traits::forward<Args>(args)...);
+            return pair<iterator, bool>(result.first, result.second);
+        }
+        // returns 1 if this call erased the key
+        unsigned erase(const Key& key) { return _list.remove_by_key(key) ? 1 : 0; }
+        // not safe concurrently with any other access
+        size_type reclaim() { return _list.reclaim(); }
+        void clear() { _list.clear(); }
+    };
+}
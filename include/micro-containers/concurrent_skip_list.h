@@ -0,0 +1,351 @@
+/*========================================================================================
+ Copyright (2021), Tomer Shalev (tomer.shalev@gmail.com, https://github.com/HendrixString).
+ All Rights Reserved.
+ License is a custom open source semi-permissive license with the following guidelines:
+ 1. unless otherwise stated, derivative work and usage of this file is permitted and
+    should be credited to the project and the author of this project.
+ 2. Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+========================================================================================*/
+#pragma once
+
+#include "traits.h"
+
+// atomics of the lock free links
+#ifndef SKIP_LIST_LOAD
+#if defined(__GNUC__) || defined(__clang__)
+#define SKIP_LIST_LOAD(variable) __atomic_load_n(&(variable), __ATOMIC_ACQUIRE)
+#define SKIP_LIST_STORE_RELAXED(variable, value) __atomic_store_n(&(variable), value, __ATOMIC_RELAXED)
+#define SKIP_LIST_CAS(variable, expected, desired) \
+        __atomic_compare_exchange_n(&(variable), &(expected), desired, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+#define SKIP_LIST_FETCH_ADD(variable, value) __atomic_fetch_add(&(variable), value, __ATOMIC_RELAXED)
+#else
+#error "concurrent_skip_list needs the __atomic builtins of gcc or clang"
+#endif
+#endif
+
+namespace microc {
+    template<class Key>
+    struct skip_list_less {
+        bool operator()(const Key &lhs, const Key &rhs) const { return lhs < rhs; }
+    };
+
+    template<class Item, class Key>
+    struct skip_list_key_extract {
+        const Key & operator()(const Item &whole) const { return whole; }
+    };
+
+    /**
+     * Concurrent Skip List, a lock free ordered list of unique keys, that many threads insert
+     * to, erase from and search at the same time, the algorithm of Herlihy and Shavit.
+     * Notes:
+     * - every node has a tower of links of a random height, a link is marked in its lowest
+     *   bit, when its node is erased. erase marks the links from the top down, and the mark
+     *   of the bottom link is the moment the item leaves the list, searches unlink marked nodes
+     * - insert links the bottom level first, at that moment the item is in the list, then the
+     *   levels above, find and lower_bound do not write and do not retry
+     * - erased nodes are not freed while threads may still walk them, they are kept in a list
+     *   of retired nodes, and freed by reclaim(), clear() or the destructor, which must not run
+     *   concurrently with any other access. A long running list calls reclaim() at quiet points.
+     * - iterators walk the bottom level and skip erased items, they see the items, that are in
+     *   the list as they pass, and stay valid until reclaim
+     * - size() is exact when no thread modifies the list
+     * - nodes and their towers are allocated together by the Allocator, which must be thread safe
+     * - the list is not copyable
+     * @tparam StoreItemType The item type, that the list stores
+     * @tparam Key The key type, that is used to compare StoreItemType
+     * @tparam Compare compare structure to compare keys less than binary relation (key_1 < key_2)
+     * @tparam KeyExtractFunction Extract a key from the stored item object
+     * @tparam Allocator allocator type
+     * @tparam MaxLevel max height of a tower, 24 levels fit lists of about 16M items well
+     */
+    template<class StoreItemType,
+             class Key=StoreItemType,
+             class Compare=skip_list_less<Key>,
+             class KeyExtractFunction=skip_list_key_extract<StoreItemType, Key>,
+             class Allocator=microc::std_allocator<char>,
+             int MaxLevel=24>
+    class concurrent_skip_list {
+    public:
+        using store_item_type = StoreItemType;
+        using key_type = Key;
+        using compare_function = Compare;
+        using key_extract_function = KeyExtractFunction;
+        using allocator_type = Allocator;
+        using size_type = microc::size_t;
+        using link_type = microc::uintptr_type;
+        static constexpr int max_level = MaxLevel;
+
+    private:
+        struct node_t {
+            StoreItemType item;
+            node_t *retired; // next in the list of retired nodes
+            link_type *next; // tower of links, right after the node
+            int height;
+            node_t(const StoreItemType &item, int height) :
+                    item(item), retired(nullptr), next(reinterpret_cast<link_type *>(this + 1)), height(height) {}
+            node_t(StoreItemType &&item, int height) :
+                    item(microc::traits::move(item)), retired(nullptr),
+                    next(reinterpret_cast<link_type *>(this + 1)), height(height) {}
+        };
+        using rebind_alloc = typename Allocator::template rebind<node_t>::other;
+
+        static node_t *ref(link_type link) { return reinterpret_cast<node_t *>(link & ~link_type(1)); }
+        static bool is_marked(link_type link) { return link & 1; }
+        static link_type link_of(const node_t *node) { return reinterpret_cast<link_type>(node); }
+
+    public:
+        struct const_iterator {
+            const node_t *_n; // node, nullptr node is end signal
+            explicit const_iterator(const node_t *n) : _n(n) {}
+            const_iterator& operator++() { _n = first_live(ref(SKIP_LIST_LOAD(_n->next[0]))); return *this;}
+            const_iterator operator++(int) {const_iterator retval(*this); ++(*this); return retval;}
+            bool operator==(const_iterator other) const {return _n == other._n;}
+            bool operator!=(const_iterator other) const {return !(*this == other);}
+            const StoreItemType & operator*() const { return _n->item; }
+        };
+        using iterator = const_iterator;
+        using insert_result = struct insert_result_t {
+            const_iterator first; bool second;
+            insert_result_t(const const_iterator &a, bool b) : first(a), second(b) {}
+        };
+
+    private:
+        Compare _compare;
+        key_extract_function _extract;
+        rebind_alloc _alloc;
+        link_type _head[MaxLevel]; // links of the head, which has no item
+        node_t *_retired;
+        size_type _size;
+        unsigned _seed;
+
+        const key_type & key_of(const node_t *node) const { return _extract(node->item); }
+        // the link of a node at a level, nullptr is the head
+        link_type & link(node_t *node, int level) { return node ? node->next[level] : _head[level]; }
+        const link_type & link(const node_t *node, int level) const { return node ? node->next[level] : _head[level]; }
+
+        // the node or the first node after it, that is not erased
+        static const node_t *first_live(const node_t *node) {
+            while (node) {
+                const link_type next = SKIP_LIST_LOAD(node->next[0]);
+                if (!is_marked(next)) break;
+                node = ref(next);
+            }
+            return node;
+        }
+        // geometric height with p=1/2, from a mixed counter
+        int random_height() {
+            unsigned x = SKIP_LIST_FETCH_ADD(_seed, 0x9E3779B9u);
+            x ^= x >> 16; x *= 0x7feb352du; x ^= x >> 15; x *= 0x846ca68bu; x ^= x >> 16;
+            int height = 1;
+            while ((x & 1) && height < MaxLevel) { ++height; x >>= 1; }
+            return height;
+        }
+        // count of node_t units of a node with its tower
+        static size_type units_of(int height) {
+            return 1 + (size_type(height) * sizeof(link_type) + sizeof(node_t) - 1) / sizeof(node_t);
+        }
+        node_t *create_node(const StoreItemType &item, int height, bool move_ctor) {
+            node_t *mem = _alloc.allocate(units_of(height));
+            if (move_ctor) ::new(mem, microc_new::blah) node_t(microc::traits::move(const_cast<StoreItemType &>(item)), height);
+            else ::new(mem, microc_new::blah) node_t(item, height);
+            return mem;
+        }
+        void destroy_node(node_t *node) {
+            const int height = node->height;
+            node->~node_t();
+            _alloc.deallocate(node, units_of(height));
+        }
+
+        /**
+         * One pass of a search, the preds and succs of the key at every level, marked nodes on
+         * the way are unlinked
+         * @return false if an unlink failed, because the pred changed, then the search restarts
+         */
+        bool try_search(const key_type &key, node_t **preds, node_t **succs) {
+            node_t *pred = nullptr;
+            for (int level = MaxLevel - 1; level >= 0; --level) {
+                node_t *current = ref(SKIP_LIST_LOAD(link(pred, level)));
+                while (current) {
+                    link_type succ = SKIP_LIST_LOAD(current->next[level]);
+                    while (is_marked(succ)) { // current is erased, unlink it at this level
+                        link_type expected = link_of(current);
+                        if (!SKIP_LIST_CAS(link(pred, level), expected, link_of(ref(succ)))) return false;
+                        current = ref(succ);
+                        if (current == nullptr) break;
+                        succ = SKIP_LIST_LOAD(current->next[level]);
+                    }
+                    if (current == nullptr || !_compare(key_of(current), key)) break;
+                    pred = current;
+                    current = ref(succ);
+                }
+                preds[level] = pred;
+                succs[level] = current;
+            }
+            return true;
+        }
+        // @return true if the bottom succ has the key
+        bool search(const key_type &key, node_t **preds, node_t **succs) {
+            while (!try_search(key, preds, succs)) {}
+            return succs[0] && !_compare(key, key_of(succs[0]));
+        }
+        // the first node, that is not less than the key, without writes, erased nodes are passed through
+        const node_t *lower_bound_node(const key_type &key) const {
+            const node_t *pred = nullptr, *current = nullptr;
+            for (int level = MaxLevel - 1; level >= 0; --level) {
+                current = ref(SKIP_LIST_LOAD(link(pred, level)));
+                while (current && _compare(key_of(current), key)) {
+                    pred = current;
+                    current = ref(SKIP_LIST_LOAD(current->next[level]));
+                }
+            }
+            return first_live(current);
+        }
+
+        const node_t *insert_node(const StoreItemType &item, bool &has_succeeded, const bool move_ctor) {
+            node_t *preds[MaxLevel], *succs[MaxLevel];
+            // the key of the item, until the node is created, which might move the item
+            const key_type *key = &_extract(item);
+            const int height = random_height();
+            node_t *node = nullptr;
+            for (;;) {
+                if (search(*key, preds, succs)) {
+                    if (node) destroy_node(node); // never published
+                    has_succeeded = false;
+                    return succs[0];
+                }
+                if (node == nullptr) {
+                    node = create_node(item, height, move_ctor);
+                    key = &key_of(node);
+                }
+                for (int level = 0; level < height; ++level)
+                    SKIP_LIST_STORE_RELAXED(node->next[level], link_of(succs[level]));
+                link_type expected = link_of(succs[0]);
+                if (SKIP_LIST_CAS(link(preds[0], 0), expected, link_of(node))) break;
+            }
+            // the item is in the list, link the levels above
+            SKIP_LIST_FETCH_ADD(_size, size_type(1));
+            has_succeeded = true;
+            for (int level = 1; level < height; ++level) {
+                for (;;) {
+                    link_type old = SKIP_LIST_LOAD(node->next[level]);
+                    if (is_marked(old)) return node; // erased meanwhile
+                    if (ref(old) != succs[level] && !SKIP_LIST_CAS(node->next[level], old, link_of(succs[level])))
+                        continue;
+                    link_type expected = link_of(succs[level]);
+                    if (SKIP_LIST_CAS(link(preds[level], level), expected, link_of(node))) break;
+                    search(*key, preds, succs);
+                    if (succs[0] != node) return node; // erased meanwhile
+                }
+            }
+            return node;
+        }
+
+        void retire(node_t *node) {
+            node_t *head = SKIP_LIST_LOAD(_retired);
+            do node->retired = head;
+            while (!SKIP_LIST_CAS(_retired, head, node));
+        }
+        // unlink every marked node at every level, when no other thread accesses the list
+        void unlink_marked() {
+            for (int level = 0; level < MaxLevel; ++level) {
+                link_type *link = &_head[level];
+                while (ref(*link)) {
+                    node_t *node = ref(*link);
+                    if (is_marked(node->next[level])) *link = link_of(ref(node->next[level]));
+                    else link = &node->next[level];
+                }
+            }
+        }
+
+    public:
+        explicit concurrent_skip_list(const Compare &comp, const Allocator &allocator = Allocator()) :
+                _compare(comp), _extract(), _alloc(allocator), _retired(nullptr), _size(0), _seed(0) {
+            for (int level = 0; level < MaxLevel; ++level) _head[level] = 0;
+        }
+        explicit concurrent_skip_list(const Allocator &allocator = Allocator()) :
+                concurrent_skip_list(Compare(), allocator) {}
+        concurrent_skip_list(const concurrent_skip_list &) = delete;
+        concurrent_skip_list &operator=(const concurrent_skip_list &) = delete;
+        ~concurrent_skip_list() { clear(); }
+
+        Allocator get_allocator() const { return Allocator(_alloc); }
+        const Compare &get_comparator() const { return _compare; }
+        size_type size() const { return SKIP_LIST_LOAD(_size); }
+        bool empty() const { return begin() == end(); }
+
+        // iterators
+        const_iterator begin() const { return const_iterator(first_live(ref(SKIP_LIST_LOAD(_head[0])))); }
+        const_iterator cbegin() const { return begin(); }
+        const_iterator end() const { return const_iterator(nullptr); }
+        const_iterator cend() const { return end(); }
+
+        // lookup, safe concurrently with modifiers
+        const_iterator lower_bound(const key_type &key) const { return const_iterator(lower_bound_node(key)); }
+        const_iterator find(const key_type &key) const {
+            const node_t *node = lower_bound_node(key);
+            return const_iterator(node && !_compare(key, key_of(node)) ? node : nullptr);
+        }
+        bool contains(const key_type &key) const { return find(key) != end(); }
+
+        // modifiers, safe concurrently with each other and with lookups
+        insert_result insert(const StoreItemType &item) {
+            bool has_succeeded = false;
+            const node_t *node = insert_node(item, has_succeeded, false);
+            return insert_result(const_iterator(node), has_succeeded);
+        }
+        insert_result insert(StoreItemType &&item) {
+            bool has_succeeded = false;
+            const node_t *node = insert_node(item, has_succeeded, true);
+            return insert_result(const_iterator(node), has_succeeded);
+        }
+        template<class... Args>
+        insert_result insert_emplace(Args &&... args) {
+            StoreItemType item(microc::traits::forward<Args>(args)...);
+            return insert(microc::traits::move(item));
+        }
+        // @return true if this call erased the key
+        bool remove_by_key(const key_type &key) {
+            node_t *preds[MaxLevel], *succs[MaxLevel];
+            if (!search(key, preds, succs)) return false;
+            node_t *victim = succs[0];
+            for (int level = victim->height - 1; level >= 1; --level) {
+                link_type succ = SKIP_LIST_LOAD(victim->next[level]);
+                while (!is_marked(succ)) SKIP_LIST_CAS(victim->next[level], succ, succ | 1);
+            }
+            link_type succ = SKIP_LIST_LOAD(victim->next[0]);
+            for (;;) {
+                if (is_marked(succ)) return false; // another thread erased it
+                if (SKIP_LIST_CAS(victim->next[0], succ, succ | 1)) break;
+            }
+            SKIP_LIST_FETCH_ADD(_size, size_type(-1));
+            search(key, preds, succs); // unlinks the node
+            retire(victim);
+            return true;
+        }
+        bool remove(const StoreItemType &item) { return remove_by_key(_extract(item)); }
+
+        // not safe concurrently with any other access
+        // free the erased nodes, @return count of freed nodes
+        size_type reclaim() {
+            unlink_marked();
+            size_type count = 0;
+            for (node_t *node = _retired, *next; node; node = next, ++count) {
+                next = node->retired;
+                destroy_node(node);
+            }
+            _retired = nullptr;
+            return count;
+        }
+        void clear() {
+            reclaim();
+            for (node_t *node = ref(_head[0]), *next; node; node = next) {
+                next = ref(node->next[0]);
+                destroy_node(node);
+            }
+            for (int level = 0; level < MaxLevel; ++level) _head[level] = 0;
+            _size = 0;
+        }
+    };
+}
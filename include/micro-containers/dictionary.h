@@ -27,16 +27,21 @@ namespace microc {
     /**
      * Dictionary is an ordered associative data structure also known as orederd_map
      * Notes:
-     * - Most algorithms use recursion, so there is a stack memory cost of O(log(n))
+     * - insert and erase are iterative, with a bounded path stack (see avl_tree)
+     * - The tree is an avl_tree by default, b_tree_backend<Order> (see b_tree.h) stores items
+     *   in arrays, which is friendlier to the cache for large sets, but then iterators are
+     *   invalidated by insert and erase
      * - This class is Allocator-Aware
      * @tparam Key the item type, that the tree stores
      * @tparam T The mapped value type of a item
      * @tparam Compare compare structure or lambda for item
      * @tparam Allocator allocator type
+     * @tparam Backend selects the tree, avl_tree_backend, avl_order_statistics_backend or b_tree_backend<Order>
      */
     template<class Key, class T,
              class Compare=dict_less<Key>,
-             class Allocator=microc::std_allocator<char>>
+             class Allocator=microc::std_allocator<char>,
+             class Backend=avl_tree_backend>
     class dictionary {
     public:
         using key_type = Key;
@@ -79,7 +84,7 @@ namespace microc {
         };
 
     public:
-        using tree_type = avl_tree<value_type, key_type, value_compare, key_extractor, Allocator>;
+        using tree_type = typename Backend::template tree<value_type, key_type, value_compare, key_extractor, Allocator>;
         using node_type = typename tree_type::node_type;
         using iterator = iterator_t<value_type &, typename tree_type::iterator>;
         using const_iterator = iterator_t<const value_type &, typename tree_type::const_iterator>;
@@ -170,6 +175,28 @@ namespace microc {
         bool contains(const Key& key) const {
             return _tree.contains_by_key(key);
         }
+        // first item, that is not less than the key
+        iterator lower_bound(const Key& key) { return iterator(_tree.lower_bound(key)); }
+        const_iterator lower_bound(const Key& key) const { return const_iterator(_tree.lower_bound(key)); }
+        // first item, that is greater than the key
+        iterator upper_bound(const Key& key) { return iterator(_tree.upper_bound(key)); }
+        const_iterator upper_bound(const Key& key) const { return const_iterator(_tree.upper_bound(key)); }
+        // the range of the items of the key, empty or one item
+        pair<iterator, iterator> equal_range(const Key& key) {
+            return pair<iterator, iterator>(lower_bound(key), upper_bound(key));
+        }
+        pair<const_iterator, const_iterator> equal_range(const Key& key) const {
+            return pair<const_iterator, const_iterator>(lower_bound(key), upper_bound(key));
+        }
+
+        // order statistics, need avl_order_statistics_backend
+        // count of keys less than a key
+        size_type rank(const Key& key) const { return _tree.rank_by_key(key); }
+        // the item at an index in order, or end
+        iterator nth(size_type index) { return iterator(_tree.select(index)); }
+        const_iterator nth(size_type index) const { return const_iterator(_tree.select(index)); }
+        // count of keys in [lo, hi)
+        size_type count_range(const Key& lo, const Key& hi) const { return _tree.count_range_by_key(lo, hi); }
 
         // element access
         T& at(const Key& key) {
@@ -206,6 +233,18 @@ namespace microc {
             auto result = _tree.insert(microc::traits::move(value));
             return pair<iterator, bool>(iterator(result.first), result.second);
         }
+        // insert with a hint, an avl backend links the item next to a correct hint without
+        // a search from the root (see avl_tree::insert_hint), returns the item of the key
+        iterator insert(const_iterator hint, const value_type& value) {
+            return iterator(_tree.insert_hint(hint._pos, value).first);
+        }
+        iterator insert(const_iterator hint, value_type && value) {
+            return iterator(_tree.insert_hint(hint._pos, microc::traits::move(value)).first);
+        }
+        template<class... Args>
+        iterator emplace_hint(const_iterator hint, Args &&... args) {
+            return iterator(_tree.insert_emplace_hint(hint._pos, microc::traits::forward<Args>(args)...).first);
+        }
     private:
         template<class A, class B>
         using match_t = microc::traits::enable_if_t<
@@ -226,6 +265,37 @@ namespace microc {
             return insert(value_type(microc::traits::forward<KK>(key),
                                      microc::traits::forward<TT>(value)));
         }
+        /**
+         * Replace the items with a sorted range in linear time (see avl_tree::assign_sorted)
+         * @param first,last forward iterators of items, sorted by key without duplicates
+         * @param verify check the order first, and keep the items as they are if it is not sorted
+         * @return false if verify failed
+         */
+        template<class ForwardIt>
+        bool assign_sorted(ForwardIt first, ForwardIt last, bool verify=true)
+        { return _tree.assign_sorted(first, last, verify); }
+        /**
+         * Insert a sorted range, that may interleave with the items (see avl_tree::insert_sorted)
+         * @param first,last forward iterators of items, sorted by key without duplicates
+         * @param verify check the order first, and keep the items as they are if it is not sorted
+         * @return false if verify failed
+         */
+        template<class ForwardIt>
+        bool insert_sorted(ForwardIt first, ForwardIt last, bool verify=true)
+        { return _tree.insert_sorted(first, last, verify); }
+        // split and set operations relink nodes, they need an avl backend (see avl_tree)
+        // this keeps the keys less than the key, returns the rest
+        dictionary split(const Key& key) {
+            dictionary right(_key_compare, get_allocator());
+            right._tree = _tree.split(key);
+            return right;
+        }
+        // append other, whose keys all succeed the keys of this, other is left empty
+        void join(dictionary & other) { _tree.join(other._tree); }
+        // move the items of other in, keys in both keep the items of this, other is left empty
+        void union_with(dictionary & other) { _tree.union_with(other._tree); }
+        void intersect_with(const dictionary & other) { _tree.intersect_with(other._tree); }
+        void difference_with(const dictionary & other) { _tree.difference_with(other._tree); }
         unsigned erase(const Key& key) {
             auto tree_size = _tree.size();
             auto tree_iter = _tree.remove_by_key(key);
@@ -233,18 +303,19 @@ namespace microc {
         }
         iterator erase(iterator pos) { return iterator(_tree.remove(*pos)); }
         iterator erase(const_iterator pos) { return iterator(_tree.remove(*pos)); }
+        // an avl backend splits out the range and joins the rest, in O(log(n) + k)
         iterator erase(const_iterator first, const_iterator last) {
-            const_iterator current(first);
-            while (current!=last) current=erase(current);
-            return current;
+            return iterator(_tree.remove_range(first._pos, last._pos));
         }
+        // erase the items with keys in [lo, hi), returns the count of erased items
+        size_type erase_range(const Key& lo, const Key& hi) { return _tree.erase_range(lo, hi); }
     };
 
-    template<class Key, class T, class Compare, class Allocator>
-    bool operator==(const dictionary<Key, T, Compare, Allocator>& lhs,
-                    const dictionary<Key, T, Compare, Allocator>& rhs ) {
+    template<class Key, class T, class Compare, class Allocator, class Backend>
+    bool operator==(const dictionary<Key, T, Compare, Allocator, Backend>& lhs,
+                    const dictionary<Key, T, Compare, Allocator, Backend>& rhs ) {
         if(!(lhs.size()==rhs.size())) return false;
-        using size_type = typename dictionary<Key, T, Compare, Allocator>::size_type;
+        using size_type = typename dictionary<Key, T, Compare, Allocator, Backend>::size_type;
         for (size_type ix = 0; ix < lhs.size(); ++ix) {
             if(!(lhs[ix]==rhs[ix])) return false;
         }
@@ -228,7 +228,7 @@ namespace microc {
         }
         void pop_back() {
             if(size()==0) return;
-            _data[_current--].~T();
+            _data[--_current].~T();
             if(size()==0 or (size()<(capacity()>>1))) alloc_(false);
         }
 
@@ -0,0 +1,431 @@
+/*========================================================================================
+ Copyright (2021), Tomer Shalev (tomer.shalev@gmail.com, https://github.com/HendrixString).
+ All Rights Reserved.
+ License is a custom open source semi-permissive license with the following guidelines:
+ 1. unless otherwise stated, derivative work and usage of this file is permitted and
+    should be credited to the project and the author of this project.
+ 2. Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+========================================================================================*/
+#pragma once
+
+#include "dynamic_array.h"
+#include "pair.h"
+
+namespace microc {
+    template<class Key>
+    struct flat_less {
+        bool operator()(const Key& lhs, const Key& rhs) const
+        {return lhs < rhs;}
+    };
+
+    //#define MICRO_CONTAINERS_ENABLE_THROW
+    #ifdef MICRO_CONTAINERS_ENABLE_THROW
+    struct throw_flat_map_out_of_range {};
+    #endif
+
+    /**
+     * Flat Map is an ordered associative container over two sorted dynamic arrays, one of
+     * keys and one of mapped values, with the same interface as dictionary.
+     * Notes:
+     * - lookup is a binary search over the keys only, and a scan walks two arrays, both are
+     *   much friendlier to the cache than a node tree, so prefer it for read mostly maps
+     * - insert and erase of a single item shift the tail, O(n), a batch insert(first, last)
+     *   appends, sorts the batch and merges it in, O(n + k log k)
+     * - iterators are indices, they are invalidated by insert and erase
+     * - dereferencing an iterator gives a pair of references, pair<const Key &, T &>
+     * - This class is Allocator-Aware
+     * @tparam Key the key type
+     * @tparam T The mapped value type of a item
+     * @tparam Compare compare structure or lambda for keys
+     * @tparam Allocator allocator type
+     */
+    template<class Key, class T,
+             class Compare=flat_less<Key>,
+             class Allocator=microc::std_allocator<char>>
+    class flat_map {
+    public:
+        using key_type = Key;
+        using mapped_type = T;
+        using value_type = pair<Key, T>;
+        using key_compare = Compare;
+        using size_type = microc::size_t;
+        using allocator_type = Allocator;
+        using reference = pair<const Key &, T &>;
+        using const_reference = pair<const Key &, const T &>;
+        using keys_type = dynamic_array<Key, Allocator>;
+        using values_type = dynamic_array<T, Allocator>;
+
+    private:
+        template<class map_pointer, class reference_type>
+        struct iterator_t {
+            map_pointer _map;
+            size_type _index;
+            template<class map_pointer_t, class reference_type_t>
+            iterator_t(const iterator_t<map_pointer_t, reference_type_t> & other) :
+                    _map(other._map), _index(other._index) {}
+            iterator_t(map_pointer map, size_type index) : _map(map), _index(index) {}
+            iterator_t& operator++() { ++_index; return *this;}
+            iterator_t& operator--() { --_index; return *this;}
+            iterator_t operator++(int) {iterator_t retval(*this); ++(*this); return retval;}
+            iterator_t operator--(int) {iterator_t retval(*this); --(*this); return retval;}
+            bool operator==(iterator_t other) const {return _index == other._index;}
+            bool operator!=(iterator_t other) const {return !(*this == other);}
+            reference_type operator*() const
+            { return reference_type(_map->_keys[_index], _map->_values[_index]); }
+            // position in the arrays
+            size_type index() const { return _index; }
+        };
+
+    public:
+        using iterator = iterator_t<flat_map *, reference>;
+        using const_iterator = iterator_t<const flat_map *, const_reference>;
+
+        // iterators
+        iterator begin() noexcept { return iterator(this, 0); }
+        const_iterator begin() const noexcept { return const_iterator(this, 0); }
+        const_iterator cbegin() const noexcept { return begin(); }
+        iterator end() noexcept { return iterator(this, size()); }
+        const_iterator end() const noexcept { return const_iterator(this, size()); }
+        const_iterator cend() const noexcept { return end(); }
+
+    private:
+        key_compare _key_compare;
+        keys_type _keys;
+        values_type _values;
+
+    public:
+        flat_map(const Compare & comp,
+                 const Allocator & allocator=Allocator()) :
+                _key_compare(comp), _keys(allocator), _values(allocator) {}
+        flat_map(const Allocator & allocator=Allocator()) :
+                flat_map(Compare(), allocator) {};
+        flat_map(const flat_map & other, const Allocator & allocator) :
+                _key_compare(other._key_compare), _keys(other._keys, allocator),
+                _values(other._values, allocator) {}
+        flat_map(const flat_map & other) : flat_map(other, other.get_allocator()) {}
+        flat_map(flat_map && other, const Allocator & allocator) :
+                _key_compare(other._key_compare),
+                _keys(microc::traits::move(other._keys), allocator),
+                _values(microc::traits::move(other._values), allocator) {
+            other.clear();
+        }
+        flat_map(flat_map && other) noexcept :
+                _key_compare(other._key_compare),
+                _keys(microc::traits::move(other._keys)),
+                _values(microc::traits::move(other._values)) {}
+        ~flat_map() = default;
+
+        flat_map & operator=(const flat_map & other) {
+            if(this!=&(other)) {
+                _key_compare = other._key_compare;
+                _keys = other._keys;
+                _values = other._values;
+            }
+            return *this;
+        }
+        flat_map & operator=(flat_map && other) noexcept {
+            if(this!=&(other)) {
+                _key_compare = other._key_compare;
+                _keys = microc::traits::move(other._keys);
+                _values = microc::traits::move(other._values);
+            }
+            return *this;
+        }
+
+        Allocator get_allocator() const { return _keys.get_allocator(); }
+        key_compare key_comp() const { return _key_compare; }
+        // the sorted arrays, for scans that only need one of them
+        const keys_type & keys() const noexcept { return _keys; }
+        const values_type & values() const noexcept { return _values; }
+
+        // capacity
+        bool empty() const noexcept { return size()==0; }
+        size_type size() const noexcept { return _keys.size(); }
+        size_type capacity() const noexcept { return _keys.capacity(); }
+        void reserve(size_type new_cap) { _keys.reserve(new_cap); _values.reserve(new_cap); }
+
+    private:
+        // index of the first key not less than the key, binary search
+        size_type lower_bound_index(const Key& key) const {
+            const Key * keys = _keys.data();
+            size_type first = 0, count = size();
+            while (count > 0) {
+                const size_type half = count >> 1;
+                if (_key_compare(keys[first + half], key)) { first += half + 1; count -= half + 1; }
+                else count = half;
+            }
+            return first;
+        }
+        // index of the first key greater than the key
+        size_type upper_bound_index(const Key& key) const {
+            const Key * keys = _keys.data();
+            size_type first = 0, count = size();
+            while (count > 0) {
+                const size_type half = count >> 1;
+                if (!_key_compare(key, keys[first + half])) { first += half + 1; count -= half + 1; }
+                else count = half;
+            }
+            return first;
+        }
+        size_type find_index(const Key& key) const {
+            const size_type index = lower_bound_index(key);
+            if (index < size() && !_key_compare(key, _keys[index])) return index;
+            return size();
+        }
+
+    public:
+        // lookup
+        iterator find(const Key& key) { return iterator(this, find_index(key)); }
+        const_iterator find(const Key& key) const { return const_iterator(this, find_index(key)); }
+        bool contains(const Key& key) const { return find_index(key)!=size(); }
+        iterator lower_bound(const Key& key) { return iterator(this, lower_bound_index(key)); }
+        const_iterator lower_bound(const Key& key) const { return const_iterator(this, lower_bound_index(key)); }
+        iterator upper_bound(const Key& key) { return iterator(this, upper_bound_index(key)); }
+        const_iterator upper_bound(const Key& key) const { return const_iterator(this, upper_bound_index(key)); }
+        pair<iterator, iterator> equal_range(const Key& key) {
+            return pair<iterator, iterator>(lower_bound(key), upper_bound(key));
+        }
+        pair<const_iterator, const_iterator> equal_range(const Key& key) const {
+            return pair<const_iterator, const_iterator>(lower_bound(key), upper_bound(key));
+        }
+
+        // order statistics, the arrays are indexed by rank
+        // count of keys less than a key
+        size_type rank(const Key& key) const { return lower_bound_index(key); }
+        // the item at an index in order, or end
+        iterator nth(size_type index) { return iterator(this, index < size() ? index : size()); }
+        const_iterator nth(size_type index) const { return const_iterator(this, index < size() ? index : size()); }
+        // count of keys in [lo, hi)
+        size_type count_range(const Key& lo, const Key& hi) const {
+            const size_type first = lower_bound_index(lo), last = lower_bound_index(hi);
+            return last > first ? last - first : 0;
+        }
+
+        // element access
+        T& at(const Key& key) {
+            const size_type index = find_index(key);
+    #ifdef MICRO_CONTAINERS_ENABLE_THROW
+            if(index==size()) throw throw_flat_map_out_of_range();
+    #endif
+            return _values[index];
+        }
+        const T& at(const Key& key) const {
+            const size_type index = find_index(key);
+    #ifdef MICRO_CONTAINERS_ENABLE_THROW
+            if(index==size()) throw throw_flat_map_out_of_range();
+    #endif
+            return _values[index];
+        }
+        T & operator[](const Key & key) {
+            return (*insert(value_type(key, T())).first).second;
+        }
+        T & operator[](Key && key) {
+            return (*insert(value_type(microc::traits::move(key), T())).first).second;
+        }
+
+    private:
+        // dynamic_array::insert grows by the inserted count, grow geometrically instead
+        void grow_for_one() {
+            if(size() < capacity()) return;
+            reserve(capacity() ? capacity() * 2 : 1);
+        }
+        template<class KK, class TT>
+        pair<iterator, bool> internal_insert(KK && key, TT && value) {
+            const size_type index = lower_bound_index(key);
+            if(index < size() && !_key_compare(key, _keys[index]))
+                return pair<iterator, bool>(iterator(this, index), false);
+            grow_for_one();
+            _keys.insert(_keys.begin() + index, Key(microc::traits::forward<KK>(key)));
+            _values.insert(_values.begin() + index, T(microc::traits::forward<TT>(value)));
+            return pair<iterator, bool>(iterator(this, index), true);
+        }
+        void swap_items(size_type a, size_type b) {
+            Key key(microc::traits::move(_keys[a]));
+            _keys[a] = microc::traits::move(_keys[b]);
+            _keys[b] = microc::traits::move(key);
+            T value(microc::traits::move(_values[a]));
+            _values[a] = microc::traits::move(_values[b]);
+            _values[b] = microc::traits::move(value);
+        }
+        // bubble down in the max heap of the items [first, first + count)
+        void heapify(size_type first, size_type count, size_type i) {
+            while (true) {
+                size_type largest = i;
+                const size_type le = (i<<1)|1, ri = (i<<1)+2;
+                if (le < count && _key_compare(_keys[first + largest], _keys[first + le])) largest = le;
+                if (ri < count && _key_compare(_keys[first + largest], _keys[first + ri])) largest = ri;
+                if (largest == i) return;
+                swap_items(first + i, first + largest);
+                i = largest;
+            }
+        }
+        // heap sort both arrays in [first, size()) by key, in place
+        void sort_tail(size_type first) {
+            const size_type count = size() - first;
+            if (count < 2) return;
+            for (size_type ix = count>>1; ix-- > 0;) heapify(first, count, ix);
+            for (size_type last = count - 1; last > 0; --last) {
+                swap_items(first, first + last);
+                heapify(first, last, 0);
+            }
+        }
+        // merge the sorted items [old_size, size()) into the sorted items [0, old_size),
+        // the old items win keys in both, one of the repeated keys of the batch is kept
+        void merge_tail(size_type old_size) {
+            const size_type total = size();
+            if (old_size == total) return;
+            // the batch is past the last key, only the repeated keys of the batch go
+            if (old_size == 0 || _key_compare(_keys[old_size - 1], _keys[old_size])) {
+                size_type write = old_size + 1;
+                for (size_type read = old_size + 1; read < total; ++read) {
+                    if (!_key_compare(_keys[write - 1], _keys[read])) continue;
+                    if (write != read) {
+                        _keys[write] = microc::traits::move(_keys[read]);
+                        _values[write] = microc::traits::move(_values[read]);
+                    }
+                    ++write;
+                }
+                if (write != total) {
+                    _keys.erase(_keys.begin() + write, _keys.end());
+                    _values.erase(_values.begin() + write, _values.end());
+                }
+                return;
+            }
+            keys_type keys(get_allocator());
+            values_type values(get_allocator());
+            keys.reserve(total); values.reserve(total);
+            size_type i = 0, j = old_size;
+            while (i < old_size || j < total) {
+                const bool take_old = j == total ||
+                        (i < old_size && !_key_compare(_keys[j], _keys[i]));
+                const size_type from = take_old ? i++ : j++;
+                if (!take_old && keys.size() && !_key_compare(keys.back(), _keys[from])) continue;
+                keys.push_back(microc::traits::move(_keys[from]));
+                values.push_back(microc::traits::move(_values[from]));
+            }
+            _keys = microc::traits::move(keys);
+            _values = microc::traits::move(values);
+        }
+        template<class ForwardIt>
+        bool is_sorted_unique(ForwardIt first, ForwardIt last) const {
+            if (first == last) return true;
+            ForwardIt previous(first);
+            for (++first; first != last; ++first, ++previous)
+                if (!_key_compare((*previous).first, (*first).first)) return false;
+            return true;
+        }
+
+    public:
+        // Modifiers
+        void clear() noexcept { _keys.clear(); _values.clear(); }
+        // clear and release the memory of the arrays
+        void drain() noexcept { _keys.drain(); _values.drain(); }
+        void shrink_to_fit() { _keys.shrink_to_fit(); _values.shrink_to_fit(); }
+        pair<iterator, bool> insert(const value_type& value) {
+            return internal_insert(value.first, value.second);
+        }
+        pair<iterator, bool> insert(value_type && value) {
+            return internal_insert(microc::traits::move(value.first), microc::traits::move(value.second));
+        }
+    private:
+        template<class A, class B>
+        using match_t = microc::traits::enable_if_t<
+                microc::traits::is_same<A,
+                        microc::traits::remove_reference_t<B>>::value>;
+        template<class A, class B>
+        using non_match_t = microc::traits::enable_if_t<
+                !microc::traits::is_same<A,
+                        microc::traits::remove_reference_t<B>>::value>;
+    public:
+        /**
+         * Batch insert, appends the items, sorts them and merges them in, O(n + k log k)
+         * instead of k shifts of the arrays. Keys that are present keep their items, if
+         * the range repeats a key, one of its items is kept
+         * @param first,last input iterators of items
+         */
+        template<class InputIt, typename Non_Key = non_match_t<Key, InputIt>>
+        void insert(InputIt first, InputIt last) {
+            const size_type old_size = size();
+            for (; first != last; ++first) {
+                auto && item = *first;
+                _keys.push_back(item.first);
+                _values.push_back(item.second);
+            }
+            sort_tail(old_size);
+            merge_tail(old_size);
+        }
+        template<class KK, class TT, typename AA = match_t<KK, Key>, typename BB = match_t<TT, T>>
+        pair<iterator, bool> insert(KK && key, TT && value) {
+            return internal_insert(microc::traits::forward<KK>(key), microc::traits::forward<TT>(value));
+        }
+        /**
+         * Replace the items with a sorted range in linear time
+         * @param first,last forward iterators of items, sorted by key without duplicates
+         * @param verify check the order first, and keep the items as they are if it is not sorted
+         * @return false if verify failed
+         */
+        template<class ForwardIt>
+        bool assign_sorted(ForwardIt first, ForwardIt last, bool verify=true) {
+            if (verify && !is_sorted_unique(first, last)) return false;
+            clear();
+            for (; first != last; ++first) {
+                auto && item = *first;
+                _keys.push_back(item.first);
+                _values.push_back(item.second);
+            }
+            return true;
+        }
+        /**
+         * Insert a sorted range, that may interleave with the items, in linear time
+         * @param first,last forward iterators of items, sorted by key without duplicates
+         * @param verify check the order first, and keep the items as they are if it is not sorted
+         * @return false if verify failed
+         */
+        template<class ForwardIt>
+        bool insert_sorted(ForwardIt first, ForwardIt last, bool verify=true) {
+            if (verify && !is_sorted_unique(first, last)) return false;
+            const size_type old_size = size();
+            for (; first != last; ++first) {
+                auto && item = *first;
+                _keys.push_back(item.first);
+                _values.push_back(item.second);
+            }
+            merge_tail(old_size);
+            return true;
+        }
+        unsigned erase(const Key& key) {
+            const size_type index = find_index(key);
+            if (index == size()) return 0;
+            erase(const_iterator(this, index));
+            return 1;
+        }
+        iterator erase(const_iterator pos) {
+            _keys.erase(_keys.begin() + pos._index);
+            _values.erase(_values.begin() + pos._index);
+            return iterator(this, pos._index);
+        }
+        iterator erase(iterator pos) { return erase(const_iterator(pos)); }
+        iterator erase(const_iterator first, const_iterator last) {
+            if (first._index < last._index) {
+                _keys.erase(_keys.begin() + first._index, _keys.begin() + last._index);
+                _values.erase(_values.begin() + first._index, _values.begin() + last._index);
+            }
+            return iterator(this, first._index);
+        }
+        // erase the items with keys in [lo, hi), one shift of the tails, returns the count of erased items
+        size_type erase_range(const Key& lo, const Key& hi) {
+            const size_type first = lower_bound_index(lo), last = lower_bound_index(hi);
+            if (first >= last) return 0;
+            erase(const_iterator(this, first), const_iterator(this, last));
+            return last - first;
+        }
+    };
+
+    template<class Key, class T, class Compare, class Allocator>
+    bool operator==(const flat_map<Key, T, Compare, Allocator>& lhs,
+                    const flat_map<Key, T, Compare, Allocator>& rhs ) {
+        return lhs.keys()==rhs.keys() && lhs.values()==rhs.values();
+    }
+}
@@ -0,0 +1,298 @@
+/*========================================================================================
+ Copyright (2021), Tomer Shalev (tomer.shalev@gmail.com, https://github.com/HendrixString).
+ All Rights Reserved.
+ License is a custom open source semi-permissive license with the following guidelines:
+ 1. unless otherwise stated, derivative work and usage of this file is permitted and
+    should be credited to the project and the author of this project.
+ 2. Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+========================================================================================*/
+#pragma once
+
+#include "dynamic_array.h"
+#include "algorithm.h"
+#include "pair.h"
+
+namespace microc {
+    template<class Key>
+    struct flat_set_less {
+        bool operator()(const Key& lhs, const Key& rhs) const
+        {return lhs < rhs;}
+    };
+
+    /**
+     * Flat Set is an ordered set over a sorted dynamic array, with the same interface as
+     * ordered_set.
+     * Notes:
+     * - lookup is a binary search and a scan walks an array, prefer it for read mostly sets
+     * - insert and erase of a single key shift the tail, O(n), a batch insert(first, last)
+     *   appends, sorts the batch and merges it in, O(n + k log k)
+     * - iterators are pointers to const keys, they are invalidated by insert and erase
+     * - This class is Allocator-Aware
+     * @tparam Key the item type, that the set stores
+     * @tparam Compare compare structure or lambda for item
+     * @tparam Allocator allocator type
+     */
+    template<class Key,
+             class Compare=flat_set_less<Key>,
+             class Allocator=microc::std_allocator<char>>
+    class flat_set {
+    public:
+        using key_type = Key;
+        using value_type = Key;
+        using size_type = microc::size_t;
+        using key_compare = Compare;
+        using value_compare = Compare;
+        using allocator_type = Allocator;
+        using reference = const value_type &;
+        using const_reference = const value_type &;
+        using pointer = const value_type *;
+        using const_pointer = const value_type *;
+        using iterator = const value_type *;
+        using const_iterator = const value_type *;
+        using keys_type = dynamic_array<Key, Allocator>;
+
+        // iterators
+        const_iterator begin() const noexcept { return _keys.begin(); }
+        const_iterator cbegin() const noexcept { return begin(); }
+        const_iterator end() const noexcept { return _keys.end(); }
+        const_iterator cend() const noexcept { return end(); }
+
+    private:
+        key_compare _key_compare;
+        keys_type _keys;
+
+    public:
+        flat_set(const Compare & comp,
+                 const Allocator & allocator=Allocator()) :
+                _key_compare(comp), _keys(allocator) {}
+        flat_set(const Allocator & allocator=Allocator()) :
+                flat_set(Compare(), allocator) {};
+        flat_set(const flat_set & other, const Allocator & allocator) :
+                _key_compare(other._key_compare), _keys(other._keys, allocator) {}
+        flat_set(const flat_set & other) : flat_set(other, other.get_allocator()) {}
+        flat_set(flat_set && other, const Allocator & allocator) :
+                _key_compare(other._key_compare),
+                _keys(microc::traits::move(other._keys), allocator) {
+            other.clear();
+        }
+        flat_set(flat_set && other) noexcept :
+                _key_compare(other._key_compare),
+                _keys(microc::traits::move(other._keys)) {}
+        ~flat_set() = default;
+
+        flat_set & operator=(const flat_set & other) {
+            if(this!=&(other)) {
+                _key_compare = other._key_compare;
+                _keys = other._keys;
+            }
+            return *this;
+        }
+        flat_set & operator=(flat_set && other) noexcept {
+            if(this!=&(other)) {
+                _key_compare = other._key_compare;
+                _keys = microc::traits::move(other._keys);
+            }
+            return *this;
+        }
+
+        Allocator get_allocator() const { return _keys.get_allocator(); }
+        key_compare key_comp() const { return _key_compare; }
+        value_compare value_comp() const { return _key_compare; }
+        // the sorted array of keys
+        const keys_type & keys() const noexcept { return _keys; }
+
+        // capacity
+        bool empty() const noexcept { return size()==0; }
+        size_type size() const noexcept { return _keys.size(); }
+        size_type capacity() const noexcept { return _keys.capacity(); }
+        void reserve(size_type new_cap) { _keys.reserve(new_cap); }
+
+    private:
+        // index of the first key not less than the key, binary search
+        size_type lower_bound_index(const Key& key) const {
+            const Key * keys = _keys.data();
+            size_type first = 0, count = size();
+            while (count > 0) {
+                const size_type half = count >> 1;
+                if (_key_compare(keys[first + half], key)) { first += half + 1; count -= half + 1; }
+                else count = half;
+            }
+            return first;
+        }
+        // index of the first key greater than the key
+        size_type upper_bound_index(const Key& key) const {
+            const Key * keys = _keys.data();
+            size_type first = 0, count = size();
+            while (count > 0) {
+                const size_type half = count >> 1;
+                if (!_key_compare(key, keys[first + half])) { first += half + 1; count -= half + 1; }
+                else count = half;
+            }
+            return first;
+        }
+        size_type find_index(const Key& key) const {
+            const size_type index = lower_bound_index(key);
+            if (index < size() && !_key_compare(key, _keys[index])) return index;
+            return size();
+        }
+
+    public:
+        // lookup
+        const_iterator find(const Key& key) const { return begin() + find_index(key); }
+        bool contains(const Key& key) const { return find_index(key)!=size(); }
+        const_iterator lower_bound(const Key& key) const { return begin() + lower_bound_index(key); }
+        const_iterator upper_bound(const Key& key) const { return begin() + upper_bound_index(key); }
+        pair<const_iterator, const_iterator> equal_range(const Key& key) const {
+            return pair<const_iterator, const_iterator>(lower_bound(key), upper_bound(key));
+        }
+
+        // order statistics, the array is indexed by rank
+        // count of keys less than a key
+        size_type rank(const Key& key) const { return lower_bound_index(key); }
+        // the item at an index in order, or end
+        const_iterator nth(size_type index) const { return begin() + (index < size() ? index : size()); }
+        // count of keys in [lo, hi)
+        size_type count_range(const Key& lo, const Key& hi) const {
+            const size_type first = lower_bound_index(lo), last = lower_bound_index(hi);
+            return last > first ? last - first : 0;
+        }
+
+    private:
+        // dynamic_array::insert grows by the inserted count, grow geometrically instead
+        void grow_for_one() {
+            if(size() < capacity()) return;
+            reserve(capacity() ? capacity() * 2 : 1);
+        }
+        template<class KK>
+        pair<iterator, bool> internal_insert(KK && key) {
+            const size_type index = lower_bound_index(key);
+            if(index < size() && !_key_compare(key, _keys[index]))
+                return pair<iterator, bool>(begin() + index, false);
+            grow_for_one();
+            _keys.insert(_keys.begin() + index, Key(microc::traits::forward<KK>(key)));
+            return pair<iterator, bool>(begin() + index, true);
+        }
+        // merge the sorted keys [old_size, size()) into the sorted keys [0, old_size),
+        // repeated keys are dropped
+        void merge_tail(size_type old_size) {
+            const size_type total = size();
+            if (old_size == total) return;
+            // the batch is past the last key, only the repeated keys of the batch go
+            if (old_size == 0 || _key_compare(_keys[old_size - 1], _keys[old_size])) {
+                size_type write = old_size + 1;
+                for (size_type read = old_size + 1; read < total; ++read) {
+                    if (!_key_compare(_keys[write - 1], _keys[read])) continue;
+                    if (write != read) _keys[write] = microc::traits::move(_keys[read]);
+                    ++write;
+                }
+                if (write != total) _keys.erase(_keys.begin() + write, _keys.end());
+                return;
+            }
+            keys_type keys(get_allocator());
+            keys.reserve(total);
+            size_type i = 0, j = old_size;
+            while (i < old_size || j < total) {
+                const bool take_old = j == total ||
+                        (i < old_size && !_key_compare(_keys[j], _keys[i]));
+                const size_type from = take_old ? i++ : j++;
+                if (!take_old && keys.size() && !_key_compare(keys.back(), _keys[from])) continue;
+                keys.push_back(microc::traits::move(_keys[from]));
+            }
+            _keys = microc::traits::move(keys);
+        }
+        template<class ForwardIt>
+        bool is_sorted_unique(ForwardIt first, ForwardIt last) const {
+            if (first == last) return true;
+            ForwardIt previous(first);
+            for (++first; first != last; ++first, ++previous)
+                if (!_key_compare(*previous, *first)) return false;
+            return true;
+        }
+
+    public:
+        // Modifiers
+        void clear() noexcept { _keys.clear(); }
+        // clear and release the memory of the array
+        void drain() noexcept { _keys.drain(); }
+        void shrink_to_fit() { _keys.shrink_to_fit(); }
+        pair<iterator, bool> insert(const value_type& value) { return internal_insert(value); }
+        pair<iterator, bool> insert(value_type && value) { return internal_insert(microc::traits::move(value)); }
+    private:
+        template<class A, class B>
+        using non_match_t = microc::traits::enable_if_t<
+                !microc::traits::is_same<A,
+                        microc::traits::remove_reference_t<B>>::value>;
+    public:
+        /**
+         * Batch insert, appends the keys, heap sorts them and merges them in, O(n + k log k)
+         * instead of k shifts of the array
+         * @param first,last input iterators of keys
+         */
+        template<class InputIt, typename Non_Key = non_match_t<Key, InputIt>>
+        void insert(InputIt first, InputIt last) {
+            const size_type old_size = size();
+            for (; first != last; ++first) _keys.push_back(*first);
+            microc::make_heap(_keys.begin() + old_size, _keys.end(), _key_compare);
+            microc::sort_heap(_keys.begin() + old_size, _keys.end(), _key_compare);
+            merge_tail(old_size);
+        }
+        /**
+         * Replace the keys with a sorted range in linear time
+         * @param first,last forward iterators of keys, sorted without duplicates
+         * @param verify check the order first, and keep the keys as they are if it is not sorted
+         * @return false if verify failed
+         */
+        template<class ForwardIt>
+        bool assign_sorted(ForwardIt first, ForwardIt last, bool verify=true) {
+            if (verify && !is_sorted_unique(first, last)) return false;
+            clear();
+            for (; first != last; ++first) _keys.push_back(*first);
+            return true;
+        }
+        /**
+         * Insert a sorted range, that may interleave with the keys, in linear time
+         * @param first,last forward iterators of keys, sorted without duplicates
+         * @param verify check the order first, and keep the keys as they are if it is not sorted
+         * @return false if verify failed
+         */
+        template<class ForwardIt>
+        bool insert_sorted(ForwardIt first, ForwardIt last, bool verify=true) {
+            if (verify && !is_sorted_unique(first, last)) return false;
+            const size_type old_size = size();
+            for (; first != last; ++first) _keys.push_back(*first);
+            merge_tail(old_size);
+            return true;
+        }
+        unsigned erase(const Key& key) {
+            const size_type index = find_index(key);
+            if (index == size()) return 0;
+            erase(begin() + index);
+            return 1;
+        }
+        iterator erase(const_iterator pos) {
+            const size_type index = pos - begin();
+            _keys.erase(_keys.begin() + index);
+            return begin() + index;
+        }
+        iterator erase(const_iterator first, const_iterator last) {
+            const size_type index = first - begin();
+            if (first < last) _keys.erase(_keys.begin() + index, _keys.begin() + (last - begin()));
+            return begin() + index;
+        }
+        // erase the keys in [lo, hi), one shift of the tail, returns the count of erased keys
+        size_type erase_range(const Key& lo, const Key& hi) {
+            const size_type first = lower_bound_index(lo), last = lower_bound_index(hi);
+            if (first >= last) return 0;
+            erase(begin() + first, begin() + last);
+            return last - first;
+        }
+    };
+
+    template<class Key, class Compare, class Allocator>
+    bool operator==(const flat_set<Key, Compare, Allocator>& lhs,
+                    const flat_set<Key, Compare, Allocator>& rhs ) {
+        return lhs.keys()==rhs.keys();
+    }
+}
@@ -0,0 +1,244 @@
+/*========================================================================================
+ Copyright (2021), Tomer Shalev (tomer.shalev@gmail.com, https://github.com/HendrixString).
+ All Rights Reserved.
+ License is a custom open source semi-permissive license with the following guidelines:
+ 1. unless otherwise stated, derivative work and usage of this file is permitted and
+    should be credited to the project and the author of this project.
+ 2. Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+========================================================================================*/
+#pragma once
+
+#include "traits.h"
+
+#ifndef MICROC_PREFETCH
+#if defined(__GNUC__) || defined(__clang__)
+#define MICROC_PREFETCH(address) __builtin_prefetch(address)
+#else
+#define MICROC_PREFETCH(address)
+#endif
+#endif
+
+namespace microc {
+
+    // count of T to allocate past the capacity, to start the array at a cache line
+    template<class T>
+    constexpr microc::size_t frozen_cache_line_slack() { return sizeof(T) < 64 ? 64 / sizeof(T) : 0; }
+    // count of T to skip from the start of an allocation to the next cache line, or 0
+    template<class T>
+    microc::size_t frozen_cache_line_offset(const T * storage) {
+        const microc::size_t bytes = (64 - microc::uintptr_type(storage) % 64) % 64;
+        return bytes % sizeof(T) == 0 && bytes / sizeof(T) <= frozen_cache_line_slack<T>() ? bytes / sizeof(T) : 0;
+    }
+
+    /**
+     * Search layouts of the frozen containers (see frozen_map.h and frozen_set.h).
+     * A layout maps the n sorted items of a frozen container to slots of an array, it
+     * does not own the items, the container stores an item at each slot the layout walks.
+     * Every layout offers:
+     * - reset(n), capacity() the count of slots to allocate, and end() the slot past the items
+     * - first(), next(slot), prev(slot), an in order walk of all the slots
+     * - lower_bound(keys, key, compare), upper_bound(keys, key, compare), which return a slot or end()
+     * Padding slots, if any, follow the last item in order and repeat it.
+     */
+
+    /**
+     * Eytzinger layout, the items of a complete binary search tree in breadth first order,
+     * slot k has children 2k and 2k+1, slot 0 is not used. The search is a loop without
+     * branches over the comparison, and the first levels are at the start of the array,
+     * so they stay cached. The search prefetches the cache line of the descendants four
+     * levels down (for 4 bytes keys), which hides most of the latency of the bottom levels.
+     */
+    class eytzinger_layout {
+    public:
+        using size_type = microc::size_t;
+
+    private:
+        size_type _size;
+
+        // count of trailing ones of k, k is never all ones
+        static unsigned trailing_ones(size_type k) {
+#if defined(__GNUC__) || defined(__clang__)
+            return unsigned(__builtin_ctzll((unsigned long long)~k));
+#else
+            unsigned count = 0;
+            for (; k & 1; k >>= 1) ++count;
+            return count;
+#endif
+        }
+        // count of trailing zeros of k, k is not zero
+        static unsigned trailing_zeros(size_type k) {
+#if defined(__GNUC__) || defined(__clang__)
+            return unsigned(__builtin_ctzll((unsigned long long)k));
+#else
+            unsigned count = 0;
+            for (; !(k & 1); k >>= 1) ++count;
+            return count;
+#endif
+        }
+        template<class Key>
+        void prefetch(const Key * keys, size_type k) const {
+            // the 64 bytes block of the descendants of k, a few levels down
+            const size_type stride = sizeof(Key) < 64 ? 64 / sizeof(Key) : 1;
+            const size_type slot = k * stride;
+            MICROC_PREFETCH(keys + (slot <= _size ? slot : 0));
+        }
+
+    public:
+        eytzinger_layout() : _size(0) {}
+        void reset(size_type size) { _size = size; }
+        size_type capacity() const { return _size ? _size + 1 : 0; }
+        size_type end() const { return 0; }
+
+        size_type first() const {
+            if (_size == 0) return end();
+            size_type k = 1;
+            while ((k << 1) <= _size) k <<= 1;
+            return k;
+        }
+        size_type last() const {
+            if (_size == 0) return end();
+            size_type k = 1;
+            while ((k << 1) + 1 <= _size) k = (k << 1) + 1;
+            return k;
+        }
+        size_type next(size_type k) const {
+            if ((k << 1) + 1 <= _size) { // leftmost of the right sub tree
+                k = (k << 1) + 1;
+                while ((k << 1) <= _size) k <<= 1;
+                return k;
+            }
+            // climb up while k is a right child, then once more, 0 past the root
+            return k >> (trailing_ones(k) + 1);
+        }
+        size_type prev(size_type k) const {
+            if (k == end()) return last();
+            if ((k << 1) <= _size) { // rightmost of the left sub tree
+                k <<= 1;
+                while ((k << 1) + 1 <= _size) k = (k << 1) + 1;
+                return k;
+            }
+            // climb up while k is a left child, then once more, 0 past the root
+            return k >> (trailing_zeros(k) + 1);
+        }
+
+        // the slot of the first key not less than the key
+        template<class Key, class Compare>
+        size_type lower_bound(const Key * keys, const Key & key, const Compare & compare) const {
+            size_type k = 1;
+            while (k <= _size) {
+                prefetch(keys, k);
+                k = (k << 1) + size_type(compare(keys[k], key));
+            }
+            // the path went right below the answer, and left at it
+            return k >> (trailing_ones(k) + 1);
+        }
+        // the slot of the first key greater than the key
+        template<class Key, class Compare>
+        size_type upper_bound(const Key * keys, const Key & key, const Compare & compare) const {
+            size_type k = 1;
+            while (k <= _size) {
+                prefetch(keys, k);
+                k = (k << 1) + size_type(!compare(key, keys[k]));
+            }
+            return k >> (trailing_ones(k) + 1);
+        }
+    };
+
+    /**
+     * S-tree layout, a static B+1 ary search tree of blocks of B sorted keys, laid out
+     * in breadth first order, block k has children k(B+1)+i+1. A block of 16 ints is a
+     * cache line, so a search touches one line per level, log_17(n) lines in total. The
+     * rank of the key in a block is a count of comparisons without branches, which the
+     * compiler vectorizes for integral keys, so the layout is limited to integral keys.
+     * The last block is padded with the last key.
+     * @tparam B keys per block, 16 for 4 bytes keys and 8 for 8 bytes keys fill a cache line
+     */
+    template<unsigned B=16>
+    class s_tree_layout {
+    public:
+        using size_type = microc::size_t;
+
+    private:
+        size_type _blocks;
+
+        static size_type child(size_type block, size_type index) { return block * (B + 1) + index + 1; }
+        size_type leftmost(size_type block) const {
+            while (child(block, 0) < _blocks) block = child(block, 0);
+            return block;
+        }
+        size_type rightmost(size_type block) const {
+            while (child(block, B) < _blocks) block = child(block, B);
+            return block;
+        }
+        // count of keys in the block less than the key, or not greater if upper
+        template<bool upper, class Key, class Compare>
+        static size_type rank(const Key * block, const Key & key, const Compare & compare) {
+            static_assert(microc::traits::is_integral<Key>::value, "s_tree_layout needs integral keys");
+            const Key value = key;
+            unsigned count = 0;
+            // gcc fully unrolls the loop inside the search, which hides it from the vectorizer
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC unroll 1
+#endif
+            for (unsigned ix = 0; ix < B; ++ix)
+                count -= -unsigned(upper ? !compare(value, block[ix]) : compare(block[ix], value));
+            return count;
+        }
+        template<bool upper, class Key, class Compare>
+        size_type search(const Key * keys, const Key & key, const Compare & compare) const {
+            size_type block = 0, result = end();
+            while (block < _blocks) {
+                const Key * keys_of_block = keys + block * B;
+                const size_type index = rank<upper>(keys_of_block, key, compare);
+                if (index < B) result = block * B + index;
+                block = child(block, index);
+            }
+            return result;
+        }
+
+    public:
+        s_tree_layout() : _blocks(0) {}
+        void reset(size_type size) { _blocks = (size + B - 1) / B; }
+        size_type capacity() const { return _blocks * B; }
+        size_type end() const { return capacity(); }
+
+        size_type first() const { return _blocks ? leftmost(0) * B : end(); }
+        size_type last() const { return _blocks ? rightmost(0) * B + B - 1 : end(); }
+        size_type next(size_type slot) const {
+            size_type block = slot / B, index = slot % B;
+            if (child(block, index + 1) < _blocks) return leftmost(child(block, index + 1)) * B;
+            if (index + 1 < B) return slot + 1;
+            // climb up until the block is not the last child
+            while (block != 0) {
+                const size_type parent = (block - 1) / (B + 1), child_index = (block - 1) % (B + 1);
+                if (child_index < B) return parent * B + child_index;
+                block = parent;
+            }
+            return end();
+        }
+        size_type prev(size_type slot) const {
+            if (slot == end()) return last();
+            size_type block = slot / B, index = slot % B;
+            if (child(block, index) < _blocks) return rightmost(child(block, index)) * B + B - 1;
+            if (index > 0) return slot - 1;
+            // climb up until the block is not the first child
+            while (block != 0) {
+                const size_type parent = (block - 1) / (B + 1), child_index = (block - 1) % (B + 1);
+                if (child_index > 0) return parent * B + child_index - 1;
+                block = parent;
+            }
+            return end();
+        }
+
+        // the slot of the first key not less than the key
+        template<class Key, class Compare>
+        size_type lower_bound(const Key * keys, const Key & key, const Compare & compare) const
+        { return search<false>(keys, key, compare); }
+        // the slot of the first key greater than the key
+        template<class Key, class Compare>
+        size_type upper_bound(const Key * keys, const Key & key, const Compare & compare) const
+        { return search<true>(keys, key, compare); }
+    };
+}
@@ -0,0 +1,252 @@
+/*========================================================================================
+ Copyright (2021), Tomer Shalev (tomer.shalev@gmail.com, https://github.com/HendrixString).
+ All Rights Reserved.
+ License is a custom open source semi-permissive license with the following guidelines:
+ 1. unless otherwise stated, derivative work and usage of this file is permitted and
+    should be credited to the project and the author of this project.
+ 2. Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+========================================================================================*/
+#pragma once
+
+#include "frozen_set.h"
+#include "pair.h"
+
+namespace microc {
+
+    //#define MICRO_CONTAINERS_ENABLE_THROW
+    #ifdef MICRO_CONTAINERS_ENABLE_THROW
+    struct throw_frozen_map_out_of_range {};
+    #endif
+
+    /**
+     * Frozen Map is an immutable ordered map, built once from sorted items or from another
+     * map (see freeze), and laid out in arrays for fast searches (see frozen_layout.h).
+     * Notes:
+     * - keys and mapped values are in two arrays in the same layout, a search only touches
+     *   the keys, and the mapped value of the result after it
+     * - The default layout is eytzinger_layout, s_tree_layout<B> is often faster for
+     *   integral keys, in vectorized builds
+     * - iteration is in order, ++ walks the layout, amortized O(1)
+     * - dereferencing an iterator gives a pair of references, pair<const Key &, const T &>
+     * - This class is Allocator-Aware
+     * @tparam Key the key type
+     * @tparam T The mapped value type of a item
+     * @tparam Compare compare structure or lambda for keys
+     * @tparam Allocator allocator type
+     * @tparam Layout eytzinger_layout or s_tree_layout<B>
+     */
+    template<class Key, class T,
+             class Compare=frozen_less<Key>,
+             class Allocator=microc::std_allocator<char>,
+             class Layout=eytzinger_layout>
+    class frozen_map {
+    public:
+        using key_type = Key;
+        using mapped_type = T;
+        using value_type = pair<Key, T>;
+        using key_compare = Compare;
+        using size_type = microc::size_t;
+        using allocator_type = Allocator;
+        using layout_type = Layout;
+        using reference = pair<const Key &, const T &>;
+        using const_reference = pair<const Key &, const T &>;
+
+        struct const_iterator {
+            const frozen_map * _map;
+            size_type _slot;
+            const_iterator(const frozen_map * map, size_type slot) : _map(map), _slot(slot) {}
+            const_iterator& operator++() { _slot = _map->next_slot(_slot); return *this;}
+            const_iterator& operator--() { _slot = _map->prev_slot(_slot); return *this;}
+            const_iterator operator++(int) {const_iterator retval(*this); ++(*this); return retval;}
+            const_iterator operator--(int) {const_iterator retval(*this); --(*this); return retval;}
+            bool operator==(const_iterator other) const {return _slot == other._slot;}
+            bool operator!=(const_iterator other) const {return !(*this == other);}
+            const_reference operator*() const
+            { return const_reference(_map->_keys[_slot], _map->_values[_slot]); }
+        };
+        using iterator = const_iterator;
+
+    private:
+        using rebind_alloc_key = typename Allocator::template rebind<Key>::other;
+        using rebind_alloc_value = typename Allocator::template rebind<T>::other;
+
+        key_compare _key_compare;
+        rebind_alloc_key _alloc_keys;
+        rebind_alloc_value _alloc_values;
+        Layout _layout;
+        Key * _storage; // allocation of the keys
+        Key * _keys; // at a cache line of the storage
+        T * _values;
+        size_type _size;
+        size_type _last; // slot of the last item
+
+        size_type next_slot(size_type slot) const { return slot == _last ? _layout.end() : _layout.next(slot); }
+        size_type prev_slot(size_type slot) const { return slot == _layout.end() ? _last : _layout.prev(slot); }
+
+        template<class ForwardIt>
+        bool is_sorted_unique(ForwardIt first, ForwardIt last) const {
+            if (first == last) return true;
+            ForwardIt previous(first);
+            for (++first; first != last; ++first, ++previous)
+                if (!_key_compare((*previous).first, (*first).first)) return false;
+            return true;
+        }
+        size_type find_slot(const Key& key) const {
+            if (_size == 0) return _layout.end();
+            const size_type slot = _layout.lower_bound(_keys, key, _key_compare);
+            if (slot != _layout.end() && !_key_compare(key, _keys[slot])) return slot;
+            return _layout.end();
+        }
+
+    public:
+        // iterators
+        const_iterator begin() const noexcept { return const_iterator(this, _size ? _layout.first() : _layout.end()); }
+        const_iterator cbegin() const noexcept { return begin(); }
+        const_iterator end() const noexcept { return const_iterator(this, _layout.end()); }
+        const_iterator cend() const noexcept { return end(); }
+
+        frozen_map(const Compare & comp,
+                   const Allocator & allocator=Allocator()) :
+                _key_compare(comp), _alloc_keys(allocator), _alloc_values(allocator), _layout(),
+                _storage(nullptr), _keys(nullptr), _values(nullptr), _size(0), _last(0) {}
+        frozen_map(const Allocator & allocator=Allocator()) :
+                frozen_map(Compare(), allocator) {};
+        frozen_map(const frozen_map & other, const Allocator & allocator) :
+                frozen_map(other._key_compare, allocator) {
+            assign_sorted(other.begin(), other.end(), false);
+        }
+        frozen_map(const frozen_map & other) : frozen_map(other, other.get_allocator()) {}
+        frozen_map(frozen_map && other) noexcept : frozen_map(other._key_compare, other.get_allocator()) {
+            *this = microc::traits::move(other);
+        }
+        ~frozen_map() { clear(); }
+
+        frozen_map & operator=(const frozen_map & other) {
+            if(this!=&(other)) {
+                _key_compare = other._key_compare;
+                assign_sorted(other.begin(), other.end(), false);
+            }
+            return *this;
+        }
+        frozen_map & operator=(frozen_map && other) noexcept {
+            if(this!=&(other)) {
+                _key_compare = other._key_compare;
+                const bool are_equal_allocators = _alloc_keys==other._alloc_keys;
+                if(!are_equal_allocators) {
+                    assign_sorted(other.begin(), other.end(), false);
+                    other.clear();
+                    return *this;
+                }
+                clear();
+                _layout = other._layout; _storage = other._storage; _keys = other._keys; _values = other._values;
+                _size = other._size; _last = other._last;
+                other._layout.reset(0); other._storage = other._keys = nullptr; other._values = nullptr;
+                other._size = 0; other._last = 0;
+            }
+            return *this;
+        }
+
+        Allocator get_allocator() const { return Allocator(_alloc_keys); }
+        key_compare key_comp() const { return _key_compare; }
+        const Layout & layout() const { return _layout; }
+
+        // capacity
+        bool empty() const noexcept { return _size==0; }
+        size_type size() const noexcept { return _size; }
+
+        /**
+         * Build from sorted items, in linear time
+         * @param first,last forward iterators of items, sorted by key without duplicates
+         * @param verify check the order first, and keep the items as they are if it is not sorted
+         * @return false if verify failed
+         */
+        template<class ForwardIt>
+        bool assign_sorted(ForwardIt first, ForwardIt last, bool verify=true) {
+            if (verify && !is_sorted_unique(first, last)) return false;
+            clear();
+            size_type count = 0;
+            for (ForwardIt it(first); it != last; ++it) ++count;
+            _layout.reset(count);
+            if (count == 0) return true;
+            _storage = _alloc_keys.allocate(_layout.capacity() + frozen_cache_line_slack<Key>());
+            _keys = _storage + frozen_cache_line_offset(_storage);
+            _values = _alloc_values.allocate(_layout.capacity());
+            size_type slot = _layout.first();
+            for (; first != last; ++first, slot = _layout.next(slot)) {
+                auto && item = *first;
+                ::new(_keys + slot, microc_new::blah) Key(item.first);
+                ::new(_values + slot, microc_new::blah) T(item.second);
+                _last = slot;
+            }
+            // padding slots repeat the last item
+            for (; slot != _layout.end(); slot = _layout.next(slot)) {
+                ::new(_keys + slot, microc_new::blah) Key(_keys[_last]);
+                ::new(_values + slot, microc_new::blah) T(_values[_last]);
+            }
+            _size = count;
+            return true;
+        }
+        void clear() noexcept {
+            if (_keys) {
+                for (size_type slot = _layout.first(); slot != _layout.end(); slot = _layout.next(slot)) {
+                    _keys[slot].~Key();
+                    _values[slot].~T();
+                }
+                _alloc_keys.deallocate(_storage, _layout.capacity() + frozen_cache_line_slack<Key>());
+                _alloc_values.deallocate(_values, _layout.capacity());
+            }
+            _layout.reset(0);
+            _storage = _keys = nullptr; _values = nullptr;
+            _size = _last = 0;
+        }
+
+        // lookup
+        const_iterator lower_bound(const Key& key) const {
+            if (_size == 0) return end();
+            return const_iterator(this, _layout.lower_bound(_keys, key, _key_compare));
+        }
+        const_iterator upper_bound(const Key& key) const {
+            if (_size == 0) return end();
+            return const_iterator(this, _layout.upper_bound(_keys, key, _key_compare));
+        }
+        pair<const_iterator, const_iterator> equal_range(const Key& key) const {
+            return pair<const_iterator, const_iterator>(lower_bound(key), upper_bound(key));
+        }
+        const_iterator find(const Key& key) const { return const_iterator(this, find_slot(key)); }
+        bool contains(const Key& key) const { return find_slot(key) != _layout.end(); }
+
+        // element access
+        const T& at(const Key& key) const {
+            const size_type slot = find_slot(key);
+    #ifdef MICRO_CONTAINERS_ENABLE_THROW
+            if(slot==_layout.end()) throw throw_frozen_map_out_of_range();
+    #endif
+            return _values[slot];
+        }
+    };
+
+    /**
+     * Freeze an ordered map (dictionary, flat_map) into a frozen_map
+     * @tparam Layout eytzinger_layout or s_tree_layout<B>
+     */
+    template<class Layout=eytzinger_layout, class Map>
+    frozen_map<typename Map::key_type, typename Map::mapped_type, typename Map::key_compare,
+               typename Map::allocator_type, Layout>
+    freeze(const Map & map) {
+        frozen_map<typename Map::key_type, typename Map::mapped_type, typename Map::key_compare,
+                   typename Map::allocator_type, Layout> frozen(map.key_comp(), map.get_allocator());
+        frozen.assign_sorted(map.begin(), map.end(), false);
+        return frozen;
+    }
+
+    template<class Key, class T, class Compare, class Allocator, class Layout>
+    bool operator==(const frozen_map<Key, T, Compare, Allocator, Layout>& lhs,
+                    const frozen_map<Key, T, Compare, Allocator, Layout>& rhs ) {
+        if(!(lhs.size()==rhs.size())) return false;
+        for (auto l = lhs.begin(), r = rhs.begin(); l != lhs.end(); ++l, ++r)
+            if(!((*l).first==(*r).first && (*l).second==(*r).second)) return false;
+        return true;
+    }
+}
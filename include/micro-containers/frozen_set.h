@@ -0,0 +1,225 @@
+/*========================================================================================
+ Copyright (2021), Tomer Shalev (tomer.shalev@gmail.com, https://github.com/HendrixString).
+ All Rights Reserved.
+ License is a custom open source semi-permissive license with the following guidelines:
+ 1. unless otherwise stated, derivative work and usage of this file is permitted and
+    should be credited to the project and the author of this project.
+ 2. Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+========================================================================================*/
+#pragma once
+
+#include "frozen_layout.h"
+#include "pair.h"
+
+namespace microc {
+    template<class Key>
+    struct frozen_less {
+        bool operator()(const Key& lhs, const Key& rhs) const
+        {return lhs < rhs;}
+    };
+
+    /**
+     * Frozen Set is an immutable ordered set, built once from sorted keys or from another
+     * set (see freeze), and laid out in an array for fast searches (see frozen_layout.h).
+     * Notes:
+     * - The default layout is eytzinger_layout, s_tree_layout<B> is often faster for
+     *   integral keys, in vectorized builds
+     * - iteration is in order, ++ walks the layout, amortized O(1)
+     * - This class is Allocator-Aware
+     * @tparam Key the item type, that the set stores
+     * @tparam Compare compare structure or lambda for item
+     * @tparam Allocator allocator type
+     * @tparam Layout eytzinger_layout or s_tree_layout<B>
+     */
+    template<class Key,
+             class Compare=frozen_less<Key>,
+             class Allocator=microc::std_allocator<char>,
+             class Layout=eytzinger_layout>
+    class frozen_set {
+    public:
+        using key_type = Key;
+        using value_type = Key;
+        using size_type = microc::size_t;
+        using key_compare = Compare;
+        using value_compare = Compare;
+        using allocator_type = Allocator;
+        using layout_type = Layout;
+        using reference = const value_type &;
+        using const_reference = const value_type &;
+
+        struct const_iterator {
+            const frozen_set * _set;
+            size_type _slot;
+            const_iterator(const frozen_set * set, size_type slot) : _set(set), _slot(slot) {}
+            const_iterator& operator++() { _slot = _set->next_slot(_slot); return *this;}
+            const_iterator& operator--() { _slot = _set->prev_slot(_slot); return *this;}
+            const_iterator operator++(int) {const_iterator retval(*this); ++(*this); return retval;}
+            const_iterator operator--(int) {const_iterator retval(*this); --(*this); return retval;}
+            bool operator==(const_iterator other) const {return _slot == other._slot;}
+            bool operator!=(const_iterator other) const {return !(*this == other);}
+            const Key & operator*() const { return _set->_keys[_slot]; }
+        };
+        using iterator = const_iterator;
+
+    private:
+        using rebind_alloc = typename Allocator::template rebind<Key>::other;
+
+        key_compare _key_compare;
+        rebind_alloc _alloc;
+        Layout _layout;
+        Key * _storage; // allocation of the keys
+        Key * _keys; // at a cache line of the storage
+        size_type _size;
+        size_type _last; // slot of the last key
+
+        size_type next_slot(size_type slot) const { return slot == _last ? _layout.end() : _layout.next(slot); }
+        size_type prev_slot(size_type slot) const { return slot == _layout.end() ? _last : _layout.prev(slot); }
+
+        template<class ForwardIt>
+        bool is_sorted_unique(ForwardIt first, ForwardIt last) const {
+            if (first == last) return true;
+            ForwardIt previous(first);
+            for (++first; first != last; ++first, ++previous)
+                if (!_key_compare(*previous, *first)) return false;
+            return true;
+        }
+
+    public:
+        // iterators
+        const_iterator begin() const noexcept { return const_iterator(this, _size ? _layout.first() : _layout.end()); }
+        const_iterator cbegin() const noexcept { return begin(); }
+        const_iterator end() const noexcept { return const_iterator(this, _layout.end()); }
+        const_iterator cend() const noexcept { return end(); }
+
+        frozen_set(const Compare & comp,
+                   const Allocator & allocator=Allocator()) :
+                _key_compare(comp), _alloc(allocator), _layout(), _storage(nullptr), _keys(nullptr), _size(0), _last(0) {}
+        frozen_set(const Allocator & allocator=Allocator()) :
+                frozen_set(Compare(), allocator) {};
+        frozen_set(const frozen_set & other, const Allocator & allocator) :
+                frozen_set(other._key_compare, allocator) {
+            assign_sorted(other.begin(), other.end(), false);
+        }
+        frozen_set(const frozen_set & other) : frozen_set(other, other.get_allocator()) {}
+        frozen_set(frozen_set && other) noexcept : frozen_set(other._key_compare, other.get_allocator()) {
+            *this = microc::traits::move(other);
+        }
+        ~frozen_set() { clear(); }
+
+        frozen_set & operator=(const frozen_set & other) {
+            if(this!=&(other)) {
+                _key_compare = other._key_compare;
+                assign_sorted(other.begin(), other.end(), false);
+            }
+            return *this;
+        }
+        frozen_set & operator=(frozen_set && other) noexcept {
+            if(this!=&(other)) {
+                _key_compare = other._key_compare;
+                const bool are_equal_allocators = _alloc==other._alloc;
+                if(!are_equal_allocators) {
+                    assign_sorted(other.begin(), other.end(), false);
+                    other.clear();
+                    return *this;
+                }
+                clear();
+                _layout = other._layout; _storage = other._storage; _keys = other._keys;
+                _size = other._size; _last = other._last;
+                other._layout.reset(0); other._storage = other._keys = nullptr;
+                other._size = 0; other._last = 0;
+            }
+            return *this;
+        }
+
+        Allocator get_allocator() const { return Allocator(_alloc); }
+        key_compare key_comp() const { return _key_compare; }
+        value_compare value_comp() const { return _key_compare; }
+        const Layout & layout() const { return _layout; }
+
+        // capacity
+        bool empty() const noexcept { return _size==0; }
+        size_type size() const noexcept { return _size; }
+
+        /**
+         * Build from sorted keys, in linear time
+         * @param first,last forward iterators of keys, sorted without duplicates
+         * @param verify check the order first, and keep the keys as they are if it is not sorted
+         * @return false if verify failed
+         */
+        template<class ForwardIt>
+        bool assign_sorted(ForwardIt first, ForwardIt last, bool verify=true) {
+            if (verify && !is_sorted_unique(first, last)) return false;
+            clear();
+            size_type count = 0;
+            for (ForwardIt it(first); it != last; ++it) ++count;
+            _layout.reset(count);
+            if (count == 0) return true;
+            _storage = _alloc.allocate(_layout.capacity() + frozen_cache_line_slack<Key>());
+            _keys = _storage + frozen_cache_line_offset(_storage);
+            size_type slot = _layout.first();
+            for (; first != last; ++first, slot = _layout.next(slot)) {
+                ::new(_keys + slot, microc_new::blah) Key(*first);
+                _last = slot;
+            }
+            // padding slots repeat the last key
+            for (; slot != _layout.end(); slot = _layout.next(slot))
+                ::new(_keys + slot, microc_new::blah) Key(_keys[_last]);
+            _size = count;
+            return true;
+        }
+        void clear() noexcept {
+            if (_keys) {
+                for (size_type slot = _layout.first(); slot != _layout.end(); slot = _layout.next(slot))
+                    _keys[slot].~Key();
+                _alloc.deallocate(_storage, _layout.capacity() + frozen_cache_line_slack<Key>());
+            }
+            _layout.reset(0);
+            _storage = _keys = nullptr;
+            _size = _last = 0;
+        }
+
+        // lookup
+        const_iterator lower_bound(const Key& key) const {
+            if (_size == 0) return end();
+            return const_iterator(this, _layout.lower_bound(_keys, key, _key_compare));
+        }
+        const_iterator upper_bound(const Key& key) const {
+            if (_size == 0) return end();
+            return const_iterator(this, _layout.upper_bound(_keys, key, _key_compare));
+        }
+        pair<const_iterator, const_iterator> equal_range(const Key& key) const {
+            return pair<const_iterator, const_iterator>(lower_bound(key), upper_bound(key));
+        }
+        const_iterator find(const Key& key) const {
+            const_iterator it = lower_bound(key);
+            if (it != end() && !_key_compare(key, *it)) return it;
+            return end();
+        }
+        bool contains(const Key& key) const { return find(key) != end(); }
+    };
+
+    /**
+     * Freeze an ordered set (ordered_set, flat_set) into a frozen_set
+     * @tparam Layout eytzinger_layout or s_tree_layout<B>
+     */
+    template<class Layout=eytzinger_layout, class Set>
+    microc::traits::enable_if_t<microc::traits::is_same<typename Set::key_type, typename Set::value_type>::value,
+            frozen_set<typename Set::key_type, typename Set::key_compare, typename Set::allocator_type, Layout>>
+    freeze(const Set & set) {
+        frozen_set<typename Set::key_type, typename Set::key_compare, typename Set::allocator_type, Layout>
+                frozen(set.key_comp(), set.get_allocator());
+        frozen.assign_sorted(set.begin(), set.end(), false);
+        return frozen;
+    }
+
+    template<class Key, class Compare, class Allocator, class Layout>
+    bool operator==(const frozen_set<Key, Compare, Allocator, Layout>& lhs,
+                    const frozen_set<Key, Compare, Allocator, Layout>& rhs ) {
+        if(!(lhs.size()==rhs.size())) return false;
+        for (auto l = lhs.begin(), r = rhs.begin(); l != lhs.end(); ++l, ++r)
+            if(!(*l==*r)) return false;
+        return true;
+    }
+}
@@ -0,0 +1,219 @@
+/*========================================================================================
+ Copyright (2021), Tomer Shalev (tomer.shalev@gmail.com, https://github.com/HendrixString).
+ All Rights Reserved.
+ License is a custom open source semi-permissive license with the following guidelines:
+ 1. unless otherwise stated, derivative work and usage of this file is permitted and
+    should be credited to the project and the author of this project.
+ 2. Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+========================================================================================*/
+#pragma once
+
+#include "traits.h"
+#include "bits_robin_lru_pool.h"
+
+namespace microc {
+    /**
+     * Interface for key equality
+     */
+    template<class Key>
+    struct lru_key_equal {
+        bool operator()(const Key &lhs, const Key &rhs) const { return lhs == rhs; }
+    };
+
+    /**
+     * LRU object Cache with arbitrary keys and constrained bits:
+     * 1. size is upto 10 bits = 1024 for 32 bits fingerprints
+     * 2. size is upto 21 bits = 2,097,152 for 64 bits fingerprints
+     * 3. compact lookup and is perfect for CPU cache
+     * This is the same as lru_cache, but the robin hood index stores a machine word
+     * fingerprint (the hash of the key) instead of the key itself. The full keys are stored
+     * in a separate array, next to the objects, and are verified on every hit, therefore
+     * fingerprint collisions can never return a wrong object.
+     *
+     * NOTES:
+     * - The index keeps the exact same layout as lru_cache, the keys array is only touched on a hit.
+     * - Two keys with the same fingerprint compete for the same entry, inserting one evicts the other.
+     * - The lower bits of the fingerprint pick the home slot, so use a hash with good low bits.
+     * - for 32 bits fingerprints, each lru fingerprint + list entry is 64 bit.
+     * - for 64 bits fingerprints, each lru fingerprint + list entry is 128 bit.
+     *
+     * @tparam Key the key type
+     * @tparam object_type The object type value to store
+     * @tparam size_bits size of cache. 10 --> 2^10=1024 entries
+     * @tparam Hash The hash struct/function must implement `size_type operator()(const Key & item) const `
+     * @tparam KeyEqual The equality struct/function must implement `bool operator()(const Key &, const Key &) const `
+     * @tparam machine_word the machine word type = short, int or long for the fingerprint
+     * @tparam Allocator allocator type
+     * @tparam wide_index use the wide index layout of the pool, which allows upto 30 bits of size
+     */
+    template<class Key, class object_type, int size_bits=10,
+             class Hash=microc::hash<Key>,
+             class KeyEqual=lru_key_equal<Key>,
+             class machine_word=long,
+             class Allocator=microc::std_allocator<char>,
+             bool wide_index=false>
+    class hashed_lru_cache {
+    private:
+        using pool_t = bits_robin_lru_pool<size_bits, machine_word, Allocator, wide_index>;
+        using _pool_iter = typename pool_t::const_iterator;
+
+        template<class value_type> struct iterator_t {
+            const hashed_lru_cache * _c; // container
+            _pool_iter _i; // index
+
+            static hashed_lru_cache * ncn(const hashed_lru_cache * node)
+            { return const_cast<hashed_lru_cache *>(node); }
+            iterator_t(_pool_iter i, const hashed_lru_cache * c) : _i(i), _c(c) {}
+            template<class value_type_t>
+            iterator_t(const iterator_t<value_type_t> & o) : iterator_t(o._i, o._c) {}
+            iterator_t& operator++() {
+                ++_i;
+                return *this;
+            }
+            iterator_t& operator--() {
+                --_i;
+                return *this;
+            }
+            iterator_t operator+(int val) {
+                iterator_t temp(*this);
+                for (int ix = 0; ix < val; ++ix) ++temp;
+                return temp;
+            }
+            iterator_t operator++(int) { iterator_t ret(_i, _c); ++(*this); return ret; }
+            iterator_t operator--(int) { iterator_t ret(_i, _c); --(*this); return ret; }
+            bool operator==(iterator_t o) const { return _i==o._i; }
+            bool operator!=(iterator_t o) const { return !(*this==o); }
+            value_type operator*() const {
+                const auto kv = *_i;
+                return { _c->_keys[kv.value], ncn(_c)->_items[kv.value] };
+            }
+        };
+
+    public:
+        using key_type = Key;
+        using value_type = object_type;
+        using size_type = int;
+        using hasher = Hash;
+        using key_equal = KeyEqual;
+        using allocator_type = Allocator;
+        using key_alloc = typename allocator_type::template rebind<key_type>::other;
+        using val_alloc = typename allocator_type::template rebind<value_type>::other;
+
+        struct pair { const key_type & key; value_type & value; };
+        struct const_pair { const key_type & key; const value_type & value; };
+
+        using iterator = iterator_t<pair>;
+        using const_iterator = iterator_t<const_pair>;
+        iterator begin() noexcept { return iterator(_pool.begin(), this); }
+        iterator end() noexcept { return iterator(_pool.end(), this); }
+        const_iterator begin() const noexcept { return const_iterator(_pool.begin(), this); }
+        const_iterator end() const noexcept { return const_iterator(_pool.end(), this); }
+
+    private:
+        pool_t _pool;
+        key_type * _keys;
+        value_type * _items;
+        key_alloc _key_allocator;
+        val_alloc _allocator;
+        hasher _hasher;
+        key_equal _equal;
+
+        machine_word fingerprint_of(const key_type & key) const {
+            return machine_word(_hasher(key));
+        }
+        void destruct_entry(int idx) {
+            (_keys + idx)->~key_type();
+            (_items + idx)->~value_type();
+        }
+
+    public:
+        explicit hashed_lru_cache(float load_factor=0.5f,
+                                  const allocator_type & allocator = allocator_type()) :
+                    _pool(load_factor, allocator), _keys(nullptr), _items(nullptr),
+                    _key_allocator(allocator), _allocator(allocator), _hasher(), _equal() {
+            _keys = _key_allocator.allocate(_pool.capacity());
+            _items = _allocator.allocate(_pool.capacity());
+        }
+        ~hashed_lru_cache() {
+            clear();
+            _key_allocator.deallocate(_keys);
+            _allocator.deallocate(_items);
+            _keys=nullptr;
+            _items=nullptr;
+        }
+
+        allocator_type get_allocator() { return allocator_type(_allocator); }
+        hasher hash_function() const { return _hasher; }
+        key_equal key_eq() const { return _equal; }
+
+        int capacity() const { return _pool.capacity(); }
+        int size() const { return _pool.size(); }
+        int maxSize() const { return _pool.maxSize(); }
+        void print(char order=1, int how_many=-1) { _pool.print(order, how_many); }
+
+        bool has(const key_type & key) const {
+            const int val = _pool.value_of(fingerprint_of(key));
+            return val!=-1 && _equal(_keys[val], key);
+        }
+        value_type * get(const key_type & key) {
+            // a fingerprint collision promotes the other key, which is harmless and
+            // saves a second probe on the common path
+            const int val = _pool.get(fingerprint_of(key));
+            if(val==-1 || !_equal(_keys[val], key)) return nullptr;
+            return _items + val;
+        }
+
+    private:
+        template<class KK, class VV>
+        void internal_put(KK && key, VV && value) {
+            const auto q = _pool.get_or_put(fingerprint_of(key));
+            // if the lazy LRU policy removed one place, let's destruct it first,
+            // because the pool might hand us the very same place
+            if(q.removed_value!=-1)
+                destruct_entry(q.removed_value);
+            auto * key_mem = _keys + q.value;
+            auto * val_mem = _items + q.value;
+            if(q.is_active) { // if active, copy/move assign with forward
+                // same fingerprint but different key, the new key takes over the entry
+                if(!_equal(*key_mem, key))
+                    *(key_mem) = microc::traits::forward<KK>(key);
+                *(val_mem) = microc::traits::forward<VV>(value);
+            } else { // if free, copy/move-construct with emplace-new forward
+                ::new(key_mem, microc_new::blah) key_type(microc::traits::forward<KK>(key));
+                ::new(val_mem, microc_new::blah) value_type(microc::traits::forward<VV>(value));
+            }
+        }
+
+    public:
+        void put(const key_type & key, const value_type & value) {
+            internal_put(key, value);
+        }
+        void put(const key_type & key, value_type && value) {
+            internal_put(key, microc::traits::move(value));
+        }
+        void put(key_type && key, value_type && value) {
+            internal_put(microc::traits::move(key), microc::traits::move(value));
+        }
+
+        bool remove(const key_type & key) {
+            const auto fp = fingerprint_of(key);
+            const int found = _pool.value_of(fp);
+            if(found==-1 || !_equal(_keys[found], key)) return false;
+            // let's destruct the free entry
+            destruct_entry(_pool.remove(fp));
+            return true;
+        }
+
+        void clear() {
+            // iterate all pool values for indices and destruct
+            // active entries
+            for (auto kv : _pool)
+                destruct_entry(kv.value);
+            // clear all active values
+            _pool.clear();
+        }
+    };
+
+}
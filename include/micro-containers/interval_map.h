@@ -0,0 +1,184 @@
+/*========================================================================================
+ Copyright (2021), Tomer Shalev (tomer.shalev@gmail.com, https://github.com/HendrixString).
+ All Rights Reserved.
+ License is a custom open source semi-permissive license with the following guidelines:
+ 1. unless otherwise stated, derivative work and usage of this file is permitted and
+    should be credited to the project and the author of this project.
+ 2. Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+========================================================================================*/
+#pragma once
+
+#include "interval_set.h"
+
+namespace microc {
+
+    //#define MICRO_CONTAINERS_ENABLE_THROW
+    #ifdef MICRO_CONTAINERS_ENABLE_THROW
+    struct throw_interval_map_out_of_range {};
+    #endif
+
+    /**
+     * extracts the interval of an item of interval_map
+     */
+    template<class Endpoint, class T>
+    struct interval_map_key_extract {
+        using key = interval<Endpoint>;
+        using item = pair<interval<Endpoint>, T>;
+        const key & operator()(const item &whole) const { return whole.first; }
+    };
+
+    /**
+     * Interval Map maps closed intervals [low, high] to values, over an avl_tree with the max
+     * endpoint augmentation (see interval_set), for example address ranges to owners, or time
+     * windows to events.
+     * Notes:
+     * - intervals are ordered by low, then by high, an interval maps to one value
+     * - insert and erase are O(log(n)), the max endpoints are updated on the path
+     * - find_overlap finds the first overlap of a query in O(log(n)), overlaps and containing
+     *   walk the overlaps in order from there, see interval_set
+     * - dereferencing an iterator gives pair<interval<Endpoint>, T> &
+     * - This class is Allocator-Aware
+     * @tparam Endpoint the endpoint type, default constructible
+     * @tparam T The mapped value type of a item
+     * @tparam Compare compare structure of endpoints, default constructible
+     * @tparam Allocator allocator type
+     */
+    template<class Endpoint, class T,
+             class Compare=interval_less<Endpoint>,
+             class Allocator=microc::std_allocator<char>>
+    class interval_map {
+    public:
+        using endpoint_type = Endpoint;
+        using key_type = interval<Endpoint>;
+        using mapped_type = T;
+        using value_type = pair<key_type, T>;
+        using size_type = microc::size_t;
+        using endpoint_compare = Compare;
+        using key_compare = interval_order<Endpoint, Compare>;
+        using allocator_type = Allocator;
+        using reference = value_type &;
+        using const_reference = const value_type &;
+        using key_extract = interval_map_key_extract<Endpoint, T>;
+        using augmentation = interval_max_augmentation<Endpoint, Compare, key_extract>;
+        using tree_type = avl_tree<value_type, key_type, key_compare, key_extract, Allocator, augmentation>;
+        using node_type = typename tree_type::node_type;
+        using iterator = typename tree_type::iterator;
+        using const_iterator = typename tree_type::const_iterator;
+        using search = interval_search<tree_type, Endpoint, Compare>;
+        using overlap_iterator = typename search::template overlap_iterator<value_type &>;
+        using const_overlap_iterator = typename search::template overlap_iterator<const value_type &>;
+        using overlap_range = typename search::template overlap_range<value_type &>;
+        using const_overlap_range = typename search::template overlap_range<const value_type &>;
+
+        // iterators
+        iterator begin() noexcept { return _tree.begin(); }
+        const_iterator begin() const noexcept { return _tree.begin(); }
+        const_iterator cbegin() const noexcept { return begin(); }
+        iterator end() noexcept { return _tree.end(); }
+        const_iterator end() const noexcept { return _tree.end(); }
+        const_iterator cend() const noexcept { return end(); }
+
+    private:
+        endpoint_compare _compare;
+        tree_type _tree;
+
+    public:
+        interval_map(const Compare & comp,
+                     const Allocator & allocator=Allocator()) :
+                _compare(comp), _tree(key_compare(comp), allocator) {}
+        interval_map(const Allocator & allocator=Allocator()) :
+                interval_map(Compare(), allocator) {};
+        interval_map(const interval_map & other, const Allocator & allocator) :
+                _compare(other._compare), _tree(other._tree, allocator) {}
+        interval_map(const interval_map & other) : interval_map(other, other.get_allocator()) {}
+        interval_map(interval_map && other, const Allocator & allocator) :
+                _compare(other._compare), _tree(microc::traits::move(other._tree), allocator) {}
+        interval_map(interval_map && other) noexcept :
+                interval_map(microc::traits::move(other), other.get_allocator()) {}
+        ~interval_map() = default;
+
+        interval_map & operator=(const interval_map & other) {
+            if(this!=&(other)) {
+                _compare = other._compare;
+                _tree = other._tree;
+            }
+            return *this;
+        }
+        interval_map & operator=(interval_map && other) noexcept {
+            if(this!=&(other)) {
+                _compare = other._compare;
+                _tree = microc::traits::move(other._tree);
+            }
+            return *this;
+        }
+
+        Allocator get_allocator() const { return _tree.get_allocator(); }
+        endpoint_compare endpoint_comp() const { return _compare; }
+        key_compare key_comp() const { return _tree.get_comparator(); }
+
+        // capacity
+        bool empty() const noexcept { return _tree.empty(); }
+        size_type size() const noexcept { return _tree.size(); }
+
+        // lookup
+        iterator find(const key_type & key) { return iterator(_tree.find_by_key(key)); }
+        const_iterator find(const key_type & key) const { return _tree.find_by_key(key); }
+        bool contains(const key_type & key) const { return _tree.contains_by_key(key); }
+        // the first item in order, whose interval overlaps [low, high], or end
+        iterator find_overlap(const Endpoint & low, const Endpoint & high)
+        { return iterator(search::first(_tree.root(), low, high, _compare), &_tree); }
+        const_iterator find_overlap(const Endpoint & low, const Endpoint & high) const
+        { return const_iterator(search::first(_tree.root(), low, high, _compare), &_tree); }
+        // the items, whose intervals overlap [low, high], in order
+        overlap_range overlaps(const Endpoint & low, const Endpoint & high)
+        { return search::template range<value_type &>(_tree, low, high, _compare); }
+        const_overlap_range overlaps(const Endpoint & low, const Endpoint & high) const
+        { return search::template range<const value_type &>(_tree, low, high, _compare); }
+        // the items, whose intervals contain the point, in order
+        overlap_range containing(const Endpoint & point) { return overlaps(point, point); }
+        const_overlap_range containing(const Endpoint & point) const { return overlaps(point, point); }
+
+        // Element Access
+        const T& at(const key_type & key) const {
+            auto iter = find(key);
+    #ifdef MICRO_CONTAINERS_ENABLE_THROW
+            if(iter==end()) throw throw_interval_map_out_of_range();
+    #endif
+            return (*iter).second;
+        }
+
+        // Modifiers
+        void clear() noexcept { _tree.clear(); }
+        // inserts the item, an interval with high less than low is not inserted
+        pair<iterator, bool> insert(const value_type & value) {
+            if (_compare(value.first.high, value.first.low)) return pair<iterator, bool>(end(), false);
+            auto result = _tree.insert(value);
+            return pair<iterator, bool>(iterator(result.first), result.second);
+        }
+        pair<iterator, bool> insert(value_type && value) {
+            if (_compare(value.first.high, value.first.low)) return pair<iterator, bool>(end(), false);
+            auto result = _tree.insert(microc::traits::move(value));
+            return pair<iterator, bool>(iterator(result.first), result.second);
+        }
+        pair<iterator, bool> insert(const Endpoint & low, const Endpoint & high, const T & value) {
+            return insert(value_type(key_type(low, high), value));
+        }
+        unsigned erase(const key_type & key) {
+            auto tree_size = _tree.size();
+            _tree.remove_by_key(key);
+            return tree_size - _tree.size();
+        }
+        iterator erase(const_iterator pos) { return iterator(_tree.remove(*pos)); }
+    };
+
+    template<class Endpoint, class T, class Compare, class Allocator>
+    bool operator==(const interval_map<Endpoint, T, Compare, Allocator>& lhs,
+                    const interval_map<Endpoint, T, Compare, Allocator>& rhs ) {
+        if(!(lhs.size()==rhs.size())) return false;
+        for (auto l = lhs.begin(), r = rhs.begin(); l != lhs.end(); ++l, ++r)
+            if(!((*l).first==(*r).first && (*l).second==(*r).second)) return false;
+        return true;
+    }
+}
@@ -0,0 +1,277 @@
+/*========================================================================================
+ Copyright (2021), Tomer Shalev (tomer.shalev@gmail.com, https://github.com/HendrixString).
+ All Rights Reserved.
+ License is a custom open source semi-permissive license with the following guidelines:
+ 1. unless otherwise stated, derivative work and usage of this file is permitted and
+    should be credited to the project and the author of this project.
+ 2. Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+========================================================================================*/
+#pragma once
+
+#include "avl_tree.h"
+#include "pair.h"
+
+namespace microc {
+    template<class Endpoint>
+    struct interval_less {
+        bool operator()(const Endpoint& lhs, const Endpoint& rhs) const
+        {return lhs < rhs;}
+    };
+
+    /**
+     * A closed interval [low, high] of endpoints
+     */
+    template<class Endpoint>
+    struct interval {
+        Endpoint low, high;
+        interval(const Endpoint & low, const Endpoint & high) : low(low), high(high) {}
+        bool operator==(const interval & other) const { return low==other.low && high==other.high; }
+        bool operator!=(const interval & other) const { return !(*this==other); }
+    };
+
+    /**
+     * Orders intervals by low endpoint, then by high endpoint
+     */
+    template<class Endpoint, class Compare>
+    struct interval_order {
+        Compare _compare;
+        explicit interval_order(const Compare & compare=Compare()) : _compare(compare) {}
+        bool operator()(const interval<Endpoint> & lhs, const interval<Endpoint> & rhs) const {
+            return _compare(lhs.low, rhs.low) ||
+                   (!_compare(rhs.low, lhs.low) && _compare(lhs.high, rhs.high));
+        }
+    };
+
+    /**
+     * Max endpoint augmentation of avl_tree, keeps the max high endpoint of every sub tree, so
+     * a search for overlapping intervals skips sub trees, that end before the query.
+     * The endpoints are compared with a default constructed Compare.
+     * @tparam Endpoint endpoint type, default constructible
+     * @tparam Compare compare structure of endpoints
+     * @tparam KeyExtract extracts the interval of a stored item
+     */
+    template<class Endpoint, class Compare, class KeyExtract>
+    struct interval_max_augmentation {
+        static constexpr bool is_augmenting = true;
+        static constexpr bool keeps_sizes = false;
+        struct node_data { Endpoint max_high; };
+        template<class node_t>
+        static void update(node_t *node) {
+            const Compare compare;
+            const Endpoint *high = &KeyExtract()(node->item).high;
+            if (node->left && compare(*high, node->left->max_high)) high = &node->left->max_high;
+            if (node->right && compare(*high, node->right->max_high)) high = &node->right->max_high;
+            node->max_high = *high;
+        }
+    };
+
+    /**
+     * In order search of the intervals, that overlap a query [low, high], over the nodes of an
+     * avl_tree with interval_max_augmentation. Sub trees, whose max endpoint is less than low,
+     * are skipped, and the search ends at the first interval, that starts after high.
+     */
+    template<class tree_type, class Endpoint, class Compare>
+    struct interval_search {
+        using node_type = typename tree_type::node_type;
+
+        static const interval<Endpoint> & interval_of(const node_type *node)
+        { return typename tree_type::key_extract_function()(node->item); }
+        // the sub tree is empty or ends before low
+        static bool is_before(const node_type *node, const Endpoint & low, const Compare & compare)
+        { return node == nullptr || compare(node->max_high, low); }
+
+        // the first overlap in the sub tree, or nullptr. if the sub tree ends at low or later,
+        // and has no overlap, then an interval in it starts after high, and so do the next ones
+        static const node_type *first(const node_type *node, const Endpoint & low, const Endpoint & high,
+                                      const Compare & compare) {
+            if (is_before(node, low, compare)) return nullptr;
+            while (node) {
+                if (!is_before(node->left, low, compare)) {
+                    node = node->left;
+                    continue;
+                }
+                const interval<Endpoint> & value = interval_of(node);
+                if (compare(high, value.low)) return nullptr;
+                if (!compare(value.high, low)) return node;
+                node = node->right;
+            }
+            return nullptr;
+        }
+        // the overlap after a node in order, or nullptr, climbs up by the parent pointers
+        static const node_type *next(const node_type *node, const Endpoint & low, const Endpoint & high,
+                                     const Compare & compare) {
+            if (!is_before(node->right, low, compare)) return first(node->right, low, high, compare);
+            // climb up until we arrive from a left sub tree, the parent is next, then its right sub tree
+            for (const node_type *parent = node->parent; parent; node = parent, parent = parent->parent) {
+                if (node != parent->left) continue;
+                const interval<Endpoint> & value = interval_of(parent);
+                if (compare(high, value.low)) return nullptr;
+                if (!compare(value.high, low)) return parent;
+                if (!is_before(parent->right, low, compare)) return first(parent->right, low, high, compare);
+            }
+            return nullptr;
+        }
+
+        /**
+         * Forward iterator over the overlaps of a query, in order
+         */
+        template<class value_reference_type>
+        struct overlap_iterator {
+            const node_type *_n; // node, nullptr node is end signal
+            Endpoint _low, _high;
+            Compare _compare;
+            overlap_iterator(const node_type *n, const Endpoint & low, const Endpoint & high,
+                             const Compare & compare) : _n(n), _low(low), _high(high), _compare(compare) {}
+            overlap_iterator& operator++() { _n = next(_n, _low, _high, _compare); return *this;}
+            overlap_iterator operator++(int) {overlap_iterator retval(*this); ++(*this); return retval;}
+            bool operator==(const overlap_iterator & other) const {return _n == other._n;}
+            bool operator!=(const overlap_iterator & other) const {return !(*this == other);}
+            value_reference_type operator*() const { return const_cast<node_type *>(_n)->item; }
+        };
+        template<class value_reference_type>
+        struct overlap_range {
+            overlap_iterator<value_reference_type> _first, _last;
+            overlap_iterator<value_reference_type> begin() const { return _first; }
+            overlap_iterator<value_reference_type> end() const { return _last; }
+            bool empty() const { return _first == _last; }
+        };
+        template<class value_reference_type>
+        static overlap_range<value_reference_type> range(const tree_type & tree, const Endpoint & low,
+                                                         const Endpoint & high, const Compare & compare) {
+            using it = overlap_iterator<value_reference_type>;
+            return { it(first(tree.root(), low, high, compare), low, high, compare),
+                     it(nullptr, low, high, compare) };
+        }
+    };
+
+    /**
+     * Interval Set is an ordered set of closed intervals [low, high], over an avl_tree with
+     * the max endpoint augmentation, that answers which intervals contain a point, or overlap
+     * an interval, without a scan of all the intervals.
+     * Notes:
+     * - intervals are ordered by low, then by high, equal intervals are kept once
+     * - insert and erase are O(log(n)), the max endpoints are updated on the path
+     * - find_overlap finds the first overlap of a query in O(log(n)), overlaps and containing
+     *   walk the overlaps in order from there, each step skips the sub trees, that end before
+     *   the query, O(log(n) + k) for k overlaps, that are near each other in order, and
+     *   O(k*log(n)) at worst
+     * - This class is Allocator-Aware
+     * @tparam Endpoint the endpoint type, default constructible
+     * @tparam Compare compare structure of endpoints, default constructible
+     * @tparam Allocator allocator type
+     */
+    template<class Endpoint,
+             class Compare=interval_less<Endpoint>,
+             class Allocator=microc::std_allocator<char>>
+    class interval_set {
+    public:
+        using endpoint_type = Endpoint;
+        using key_type = interval<Endpoint>;
+        using value_type = interval<Endpoint>;
+        using size_type = microc::size_t;
+        using endpoint_compare = Compare;
+        using key_compare = interval_order<Endpoint, Compare>;
+        using value_compare = key_compare;
+        using allocator_type = Allocator;
+        using reference = const value_type &;
+        using const_reference = const value_type &;
+        using key_extract = avl_key_extract<value_type, value_type>;
+        using augmentation = interval_max_augmentation<Endpoint, Compare, key_extract>;
+        using tree_type = avl_tree<value_type, value_type, key_compare, key_extract, Allocator, augmentation>;
+        using node_type = typename tree_type::node_type;
+        using iterator = typename tree_type::const_iterator;
+        using const_iterator = typename tree_type::const_iterator;
+        using search = interval_search<tree_type, Endpoint, Compare>;
+        using overlap_iterator = typename search::template overlap_iterator<const value_type &>;
+        using overlap_range = typename search::template overlap_range<const value_type &>;
+
+        // iterators
+        const_iterator begin() const noexcept { return _tree.begin(); }
+        const_iterator cbegin() const noexcept { return begin(); }
+        const_iterator end() const noexcept { return _tree.end(); }
+        const_iterator cend() const noexcept { return end(); }
+
+    private:
+        endpoint_compare _compare;
+        tree_type _tree;
+
+    public:
+        interval_set(const Compare & comp,
+                     const Allocator & allocator=Allocator()) :
+                _compare(comp), _tree(key_compare(comp), allocator) {}
+        interval_set(const Allocator & allocator=Allocator()) :
+                interval_set(Compare(), allocator) {};
+        interval_set(const interval_set & other, const Allocator & allocator) :
+                _compare(other._compare), _tree(other._tree, allocator) {}
+        interval_set(const interval_set & other) : interval_set(other, other.get_allocator()) {}
+        interval_set(interval_set && other, const Allocator & allocator) :
+                _compare(other._compare), _tree(microc::traits::move(other._tree), allocator) {}
+        interval_set(interval_set && other) noexcept :
+                interval_set(microc::traits::move(other), other.get_allocator()) {}
+        ~interval_set() = default;
+
+        interval_set & operator=(const interval_set & other) {
+            if(this!=&(other)) {
+                _compare = other._compare;
+                _tree = other._tree;
+            }
+            return *this;
+        }
+        interval_set & operator=(interval_set && other) noexcept {
+            if(this!=&(other)) {
+                _compare = other._compare;
+                _tree = microc::traits::move(other._tree);
+            }
+            return *this;
+        }
+
+        Allocator get_allocator() const { return _tree.get_allocator(); }
+        endpoint_compare endpoint_comp() const { return _compare; }
+        key_compare key_comp() const { return _tree.get_comparator(); }
+
+        // capacity
+        bool empty() const noexcept { return _tree.empty(); }
+        size_type size() const noexcept { return _tree.size(); }
+
+        // lookup
+        const_iterator find(const value_type & value) const { return _tree.find(value); }
+        bool contains(const value_type & value) const { return _tree.contains(value); }
+        // the first interval in order, that overlaps [low, high], or end
+        const_iterator find_overlap(const Endpoint & low, const Endpoint & high) const
+        { return const_iterator(search::first(_tree.root(), low, high, _compare), &_tree); }
+        // the intervals, that overlap [low, high], in order
+        overlap_range overlaps(const Endpoint & low, const Endpoint & high) const
+        { return search::template range<const value_type &>(_tree, low, high, _compare); }
+        // the intervals, that contain the point, in order
+        overlap_range containing(const Endpoint & point) const { return overlaps(point, point); }
+
+        // Modifiers
+        void clear() noexcept { _tree.clear(); }
+        // inserts the interval, an interval with high less than low is not inserted
+        pair<iterator, bool> insert(const value_type & value) {
+            if (_compare(value.high, value.low)) return pair<iterator, bool>(end(), false);
+            auto result = _tree.insert(value);
+            return pair<iterator, bool>(result.first, result.second);
+        }
+        pair<iterator, bool> insert(const Endpoint & low, const Endpoint & high) {
+            return insert(value_type(low, high));
+        }
+        unsigned erase(const value_type & value) {
+            auto tree_size = _tree.size();
+            _tree.remove(value);
+            return tree_size - _tree.size();
+        }
+        iterator erase(const_iterator pos) { return _tree.remove(*pos); }
+    };
+
+    template<class Endpoint, class Compare, class Allocator>
+    bool operator==(const interval_set<Endpoint, Compare, Allocator>& lhs,
+                    const interval_set<Endpoint, Compare, Allocator>& rhs ) {
+        if(!(lhs.size()==rhs.size())) return false;
+        for (auto l = lhs.begin(), r = rhs.begin(); l != lhs.end(); ++l, ++r)
+            if(!(*l==*r)) return false;
+        return true;
+    }
+}
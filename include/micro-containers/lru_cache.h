@@ -12,6 +12,8 @@
 
 #include "bits_linear_probe_lru_pool.h"
 #include "bits_robin_lru_pool.h"
+#include "lru_timer_wheel.h"
+#include "lru_listeners.h"
 
 namespace microc {
 #define LRU_PRINT_SEQ 0
@@ -36,16 +38,31 @@ namespace microc {
      * - for 64 bits keys, each lru key + list entry is 128 bit.
      * - The size of the cache is a power of 2 of the bits for value, which gives some optimizations.
      * - perfect for small caches: up to 1024 entries for 32 bit keys and 2,097,152 for 64 bit keys.
+     * - capacity can also be chosen at run-time, upto size_bits, and changed later with resize().
+     * - weighted mode bounds the total cost of the entries, given at put(), by a budget as well as
+     *   by the entry count. Entries are evicted from the LRU tail until the budget is met.
+     * - expiring mode gives entries, that were put with put_with_ttl(), an expiry time on a user clock.
+     *   Expired entries are removed lazily on access, and incrementally with expire_some().
+     * - an eviction listener sees every evicted or expired entry before its object is destructed,
+     *   use lru_eviction_buffer to collect them and drain them in batches (write-back).
      *
      * @tparam object_type The object type value to store
-     * @tparam size_bits size of cache. 10 --> 2^10=1024 entries
+     * @tparam size_bits (maximal) size of cache. 10 --> 2^10=1024 entries
      * @tparam machine_word the machine word type = short, int or long for key
+     * @tparam wide_index use the wide index layout of the pool, which allows upto 30 bits of size
+     * @tparam weighted track a cost per entry and evict by a weight budget, see set_max_weight()
+     * @tparam expiring track an expiry time per entry, see put_with_ttl() and expire_some()
+     * @tparam EvictionListener function struct `void operator()(machine_word key, object_type & object)`,
+     *         that is invoked before an evicted or expired object is destructed
      */
     template<class object_type, int size_bits=10,
-            class machine_word=long, class Allocator=void>
+            class machine_word=long, class Allocator=void, bool wide_index=false,
+            bool weighted=false, bool expiring=false,
+            class EvictionListener=lru_null_listener>
     class lru_cache {
     private:
-        using pool_t = bits_robin_lru_pool<size_bits, machine_word, Allocator>;
+        using pool_t = bits_robin_lru_pool<size_bits, machine_word, Allocator, wide_index>;
+        using wheel_t = lru_timer_wheel<machine_word, Allocator>;
         using _pool_iter = typename pool_t::const_iterator;
 
         template<class value_type> struct iterator_t {
@@ -85,6 +102,10 @@ namespace microc {
         using size_type = int;
         using allocator_type = Allocator;
         using val_alloc = typename allocator_type::template rebind<value_type>::other;
+        using weight_type = unsigned long;
+        using weight_alloc = typename allocator_type::template rebind<weight_type>::other;
+        using time_type = typename wheel_t::time_type;
+        using eviction_listener_type = EvictionListener;
 
         struct pair { machine_word key; value_type & value; };
         struct const_pair { machine_word key; const value_type & value; };
@@ -100,62 +121,384 @@ namespace microc {
         pool_t _pool;
         value_type * _items;
         val_alloc _allocator;
+        // weights are only allocated in weighted mode
+        weight_type * _weights;
+        weight_alloc _weight_allocator;
+        weight_type _weight, _max_weight;
+        unsigned long _evictions;
+        // expiry entries are only allocated in expiring mode
+        wheel_t _wheel;
+        time_type _now;
+        unsigned long _expirations;
+        eviction_listener_type _listener;
+#ifdef LRU_CACHE_ENABLE_STATS
+        // lookups and puts are counted here, probe distances are counted by the pool
+        lru_stats _stats;
+#endif
+
+        void allocate_items() {
+            _items = _allocator.allocate(_pool.capacity());
+            if(weighted) _weights = _weight_allocator.allocate(_pool.capacity());
+            if(expiring) _wheel.init(_pool.capacity());
+        }
 
     public:
         explicit lru_cache(float load_factor=0.5f,
                            const allocator_type & allocator = allocator_type()) :
-                    _pool(load_factor, allocator), _allocator(allocator), _items(nullptr) {
-            _items = _allocator.allocate(_pool.capacity());
+                    _pool(load_factor, allocator), _allocator(allocator), _items(nullptr),
+                    _weights(nullptr), _weight_allocator(allocator), _weight(0),
+                    _max_weight(~weight_type(0)), _evictions(0),
+                    _wheel(allocator), _now(0), _expirations(0), _listener() {
+            allocate_items();
+        }
+        /**
+         * construct a cache with a run-time capacity of 2^capacity_bits entries
+         * @param capacity_bits capacity bits in [1, size_bits], out of range values are clamped
+         * @param load_factor the load factor
+         * @param allocator the allocator
+         */
+        lru_cache(int capacity_bits, float load_factor,
+                  const allocator_type & allocator = allocator_type()) :
+                    _pool(capacity_bits, load_factor, allocator), _allocator(allocator), _items(nullptr),
+                    _weights(nullptr), _weight_allocator(allocator), _weight(0),
+                    _max_weight(~weight_type(0)), _evictions(0),
+                    _wheel(allocator), _now(0), _expirations(0), _listener() {
+            allocate_items();
         }
         ~lru_cache() {
             clear();
             _allocator.deallocate(_items);
+            if(_weights) _weight_allocator.deallocate(_weights);
             _items=nullptr;
+            _weights=nullptr;
         }
 
         allocator_type get_allocator() { return _allocator; }
 
-        constexpr int capacity() const { return _pool.capacity(); }
+        int capacity() const { return _pool.capacity(); }
         int size() const { return _pool.size(); }
         int maxSize() const { return _pool.maxSize(); }
+        // total cost of active entries, always 0 if not weighted
+        weight_type weight() const { return _weight; }
+        weight_type maxWeight() const { return _max_weight; }
+        // count of entries evicted by the LRU policy (by count or by weight), removals excluded
+        unsigned long evictions() const { return _evictions; }
+        /**
+         * set the weight budget, evicts least recently used entries if the budget is exceeded.
+         * Has no effect if not weighted.
+         */
+        void set_max_weight(weight_type max_weight) {
+            if(!weighted) return;
+            _max_weight = max_weight;
+            adjust_weight(false);
+        }
+        eviction_listener_type & eviction_listener() { return _listener; }
+        const eviction_listener_type & eviction_listener() const { return _listener; }
+        void set_eviction_listener(const eviction_listener_type & listener) { _listener = listener; }
+        // the latest time, that the cache was told about
+        time_type now() const { return _now; }
+        // count of entries removed because they expired
+        unsigned long expirations() const { return _expirations; }
+        time_type time_resolution() const { return _wheel.resolution(); }
+        /**
+         * set the time span of an expiry bucket, the wheel has lru_timer_wheel::wheel_size buckets,
+         * so a good resolution is around the typical ttl divided by the wheel size.
+         */
+        void set_time_resolution(time_type resolution) {
+            if(!expiring) return;
+            _wheel.clear();
+            _wheel.set_resolution(resolution);
+            for (auto kv : _pool) _wheel.relink(kv.value);
+        }
         void print(char order=1, int how_many=-1) { _pool.print(order, how_many); }
+#ifdef LRU_CACHE_ENABLE_STATS
+        /**
+         * snapshot of the counters. hits and misses count get() calls (an expired entry is a miss),
+         * inserts count puts of new keys, evictions count LRU and weight evictions, removals count
+         * remove() calls, that found the key. The probe distance is of the pool's get_or_put.
+         */
+        lru_stats stats() const {
+            auto stats = _stats;
+            const auto pool_stats = _pool.stats();
+            stats.probe_distance = pool_stats.probe_distance;
+            stats.probes = pool_stats.probes;
+            return stats;
+        }
+        void reset_stats() { _stats.reset(); _pool.reset_stats(); }
+#endif
 
-        bool has(machine_word key) const { return _pool.has(key); }
+        /**
+         * query a key without affecting the LRU list. An expired key is reported missing.
+         */
+        bool has(machine_word key) const {
+            const int val = _pool.value_of(key);
+            return val!=-1 && !(expiring && _wheel.is_expired(val, _now));
+        }
         value_type * get(machine_word key) {
             int val = _pool.get(key);
-            return val==-1 ? nullptr : (_items + val);
+            if(val==-1) {
+                LRU_STATS_COUNT(++_stats.misses)
+                return nullptr;
+            }
+            if(expiring && _wheel.is_expired(val, _now)) {
+                expire_value(val);
+                LRU_STATS_COUNT(++_stats.misses)
+                return nullptr;
+            }
+            LRU_STATS_COUNT(++_stats.hits)
+            return _items + val;
+        }
+        value_type * get(machine_word key, time_type now) {
+            advance_time(now);
+            return get(key);
         }
 
     private:
+        void advance_time(time_type now) { if(now > _now) _now = now; }
+        static time_type expiry_time(time_type now, time_type ttl) {
+            return ttl >= wheel_t::never - now ? wheel_t::never - 1 : now + ttl;
+        }
+        void destruct_item(int val) {
+            (_items + val)->~value_type();
+            if(weighted) _weight -= _weights[val];
+            if(expiring) _wheel.unlink(val);
+        }
+        void evict_item(machine_word key, int val) {
+            _listener(key, _items[val]);
+            destruct_item(val);
+        }
+        void expire_value(int val) {
+            const machine_word key = _wheel.key_of(val);
+            evict_item(key, _pool.remove(key));
+            ++_expirations;
+        }
+        /**
+         * evict from the LRU tail until the weight budget is met
+         * @param keep_mru never evict the most recently used entry, that was just put
+         */
+        void adjust_weight(bool keep_mru) {
+            if(!weighted) return;
+            while(_weight > _max_weight && _pool.size()) {
+                if(_pool.size()==1 && keep_mru) break;
+                machine_word key;
+                const int val = _pool.remove_lru(&key);
+                evict_item(key, val);
+                ++_evictions;
+                LRU_STATS_COUNT(++_stats.evictions)
+            }
+        }
         template<class VV>
-        void internal_put(machine_word key, VV && value) {
+        void internal_put(machine_word key, VV && value, weight_type cost, time_type at) {
             const auto q = _pool.get_or_put(key);
+            // if the lazy LRU policy removed one place, let's destruct it first,
+            // because the pool might hand us the very same place
+            if(q.removed_value!=-1) {
+                evict_item(q.removed_key, q.removed_value);
+                ++_evictions;
+                LRU_STATS_COUNT(++_stats.evictions)
+            }
             auto * val_mem = _items + q.value;
-            if(q.is_active) // if active, copy/move assign with forward
+            if(q.is_active) { // if active, copy/move assign with forward
                 *(val_mem) = microc::traits::forward<VV>(value);
-            else // if free, copy/move-construct with emplace-new forward
+                if(weighted) _weight -= _weights[q.value];
+            } else { // if free, copy/move-construct with emplace-new forward
                 ::new(val_mem, microc_new::blah) value_type(microc::traits::forward<VV>(value));
-            // now, if the lazy LRU policy removed one place, let's destruct it
-            if(q.removed_value!=-1)
-                (_items + q.removed_value)->~value_type();
+                LRU_STATS_COUNT(++_stats.inserts)
+            }
+            if(expiring) {
+                if(q.is_active) _wheel.unlink(q.value);
+                _wheel.link(q.value, key, at);
+            }
+            if(weighted) {
+                _weights[q.value] = cost;
+                _weight += cost;
+                adjust_weight(true);
+            }
         }
 
     public:
-        void put(machine_word key, const value_type & value) {
-            internal_put(key, value);
+        /**
+         * put a value
+         * @param key the key
+         * @param value the value
+         * @param cost the weight of the entry, ignored if not weighted. An entry, that is heavier
+         *        than the budget, evicts all others and stays alone.
+         */
+        void put(machine_word key, const value_type & value, weight_type cost=1) {
+            internal_put(key, value, cost, wheel_t::never);
         }
-        void put(machine_word key, value_type && value) {
-            internal_put(key, microc::traits::move(value));
+        void put(machine_word key, value_type && value, weight_type cost=1) {
+            internal_put(key, microc::traits::move(value), cost, wheel_t::never);
+        }
+        /**
+         * put a value, that expires at now+ttl. Without expiring mode, this is a regular put.
+         * @param key the key
+         * @param value the value
+         * @param ttl time to live
+         * @param now the current time of the user clock
+         * @param cost the weight of the entry, ignored if not weighted.
+         */
+        void put_with_ttl(machine_word key, const value_type & value,
+                          time_type ttl, time_type now, weight_type cost=1) {
+            advance_time(now);
+            internal_put(key, value, cost, expiry_time(now, ttl));
+        }
+        void put_with_ttl(machine_word key, value_type && value,
+                          time_type ttl, time_type now, weight_type cost=1) {
+            advance_time(now);
+            internal_put(key, microc::traits::move(value), cost, expiry_time(now, ttl));
+        }
+
+        /**
+         * incrementally remove expired entries
+         * @param now the current time of the user clock
+         * @param budget how many entries (and empty buckets) to examine at most
+         * @return count of removed entries
+         */
+        int expire_some(time_type now, int budget=64) {
+            advance_time(now);
+            if(!expiring) return 0;
+            return _wheel.expire(_now, budget, [this](int val) { expire_value(val); });
         }
 
         bool remove(machine_word key) {
             int val = _pool.remove(key);
             if(val==-1) return false;
             // let's destruct the free item
-            (_items + val)->~value_type();
+            destruct_item(val);
+            LRU_STATS_COUNT(++_stats.removals)
             return true;
         }
 
+        /**
+         * change the capacity to 2^capacity_bits entries. When shrinking, only the most
+         * recently used entries, that fit the new max size, are kept, and the rest are evicted
+         * through the eviction listener. Recency order is preserved.
+         * @param capacity_bits capacity bits in [1, size_bits], out of range values are clamped
+         */
+        void resize(int capacity_bits) {
+            pool_t pool(capacity_bits, _pool.loadFactor(), allocator_type(_allocator));
+            value_type * items = _allocator.allocate(pool.capacity());
+            weight_type * weights = weighted ? _weight_allocator.allocate(pool.capacity()) : nullptr;
+            wheel_t wheel{allocator_type(_allocator)};
+            if(expiring) {
+                wheel.init(pool.capacity());
+                wheel.set_resolution(_wheel.resolution());
+            }
+            int excess = _pool.size() - pool.maxSize();
+            // walk from the LRU tail towards the MRU head, so the head is inserted last
+            for (auto it = _pool.lru(); it != _pool.end(); --it) {
+                const auto kv = *it;
+                if(excess-- <= 0) {
+                    const auto q = pool.get_or_put(kv.key);
+                    ::new(items + q.value, microc_new::blah) value_type(microc::traits::move(_items[kv.value]));
+                    if(weighted) weights[q.value] = _weights[kv.value];
+                    if(expiring) wheel.link(q.value, kv.key, _wheel.expiry_of(kv.value));
+                    (_items + kv.value)->~value_type();
+                } else {
+                    evict_item(kv.key, kv.value);
+                    ++_evictions;
+                    LRU_STATS_COUNT(++_stats.evictions)
+                }
+            }
+            _allocator.deallocate(_items);
+            _items = items;
+            if(weighted) {
+                _weight_allocator.deallocate(_weights);
+                _weights = weights;
+            }
+            if(expiring) _wheel.swap(wheel);
+            _pool.swap(pool);
+        }
+
+        // size in bytes of the image of the cache
+        unsigned long serialized_size() const {
+            return _pool.serialized_size() + lru_image::aligned(sizeof(lru_image::cache_header)) +
+                   lru_image::aligned(sizeof(value_type) * capacity()) +
+                   (weighted ? lru_image::aligned(sizeof(weight_type) * capacity()) : 0);
+        }
+        /**
+         * write a binary image of the cache: the pool image, followed by the raw objects array
+         * (and weights), so a restore is a few bulk copies and keeps the recency order.
+         * Only for trivially copyable objects and caches, that are not expiring.
+         * @param image destination memory, better aligned to lru_image::alignment
+         * @param size size of the destination in bytes
+         * @return bytes written, or 0 if the destination is too small
+         */
+        unsigned long serialize(void * image, unsigned long size) const {
+            static_assert(microc::traits::is_trivially_copyable<value_type>::value,
+                          "only trivially copyable objects can be serialized");
+            static_assert(!expiring, "expiring caches can not be serialized");
+            if(size < serialized_size()) return 0;
+            auto * bytes = static_cast<unsigned char *>(image);
+            unsigned long offset = _pool.serialize(bytes, size);
+            lru_image::cache_header header;
+            header.magic = lru_image::cache_magic;
+            header.version = lru_image::version;
+            header.object_size = sizeof(value_type);
+            header.weight_size = weighted ? sizeof(weight_type) : 0;
+            header.capacity = capacity();
+            lru_image::copy_bytes(bytes + offset, &header, sizeof(header));
+            offset += lru_image::aligned(sizeof(header));
+            lru_image::copy_bytes(bytes + offset, _items, sizeof(value_type) * capacity());
+            offset += lru_image::aligned(sizeof(value_type) * capacity());
+            if(weighted) {
+                lru_image::copy_bytes(bytes + offset, _weights, sizeof(weight_type) * capacity());
+                offset += lru_image::aligned(sizeof(weight_type) * capacity());
+            }
+            return offset;
+        }
+        /**
+         * restore the cache from an image, that was written by a cache of the same type.
+         * The current entries are discarded (without notifying the eviction listener), the
+         * max weight is kept, and excess weight of the image is evicted.
+         * @param image source memory, for example an mmap'd file
+         * @param size size of the source in bytes
+         * @return bytes read, or 0 if the image is incompatible, in which case the cache is untouched
+         */
+        unsigned long deserialize(const void * image, unsigned long size) {
+            static_assert(microc::traits::is_trivially_copyable<value_type>::value,
+                          "only trivially copyable objects can be serialized");
+            static_assert(!expiring, "expiring caches can not be serialized");
+            const auto * bytes = static_cast<const unsigned char *>(image);
+            // validate everything before touching the cache
+            pool_t pool(1, _pool.loadFactor(), allocator_type(_allocator));
+            unsigned long offset = pool.deserialize(bytes, size);
+            if(offset==0 || size < offset + lru_image::aligned(sizeof(lru_image::cache_header)))
+                return 0;
+            lru_image::cache_header header;
+            lru_image::copy_bytes(&header, bytes + offset, sizeof(header));
+            const unsigned long count = pool.capacity();
+            const bool compatible = header.magic==lru_image::cache_magic &&
+                    header.version==lru_image::version && header.object_size==sizeof(value_type) &&
+                    header.weight_size==(weighted ? sizeof(weight_type) : 0) &&
+                    header.capacity==pool.capacity();
+            const unsigned long needed = offset + lru_image::aligned(sizeof(header)) +
+                    lru_image::aligned(sizeof(value_type) * count) +
+                    (weighted ? lru_image::aligned(sizeof(weight_type) * count) : 0);
+            if(!compatible || size < needed) return 0;
+            offset += lru_image::aligned(sizeof(header));
+            clear();
+            if(pool.capacity() != capacity()) {
+                _allocator.deallocate(_items);
+                _items = _allocator.allocate(count);
+                if(weighted) {
+                    _weight_allocator.deallocate(_weights);
+                    _weights = _weight_allocator.allocate(count);
+                }
+            }
+            _pool.swap(pool);
+            lru_image::copy_bytes(_items, bytes + offset, sizeof(value_type) * count);
+            offset += lru_image::aligned(sizeof(value_type) * count);
+            if(weighted) {
+                lru_image::copy_bytes(_weights, bytes + offset, sizeof(weight_type) * count);
+                offset += lru_image::aligned(sizeof(weight_type) * count);
+                for (auto kv : _pool) _weight += _weights[kv.value];
+                adjust_weight(false);
+            }
+            return offset;
+        }
+
         void clear() {
             // iterate all pool values for indices and destruct
             // active items
@@ -163,6 +506,8 @@ namespace microc {
                 (_items + kv.value)->~value_type();
             // clear all active values
             _pool.clear();
+            _weight = 0;
+            if(expiring) _wheel.clear();
         }
     };
 
@@ -0,0 +1,54 @@
+/*========================================================================================
+ Copyright (2021), Tomer Shalev (tomer.shalev@gmail.com, https://github.com/HendrixString).
+ All Rights Reserved.
+ License is a custom open source semi-permissive license with the following guidelines:
+ 1. unless otherwise stated, derivative work and usage of this file is permitted and
+    should be credited to the project and the author of this project.
+ 2. Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+========================================================================================*/
+#pragma once
+
+namespace microc {
+    /**
+     * Binary images of the lru containers, for snapshots and warm restarts.
+     * An image is a header followed by raw arrays, every section starts at a multiple of
+     * `alignment` bytes from the start of the image, so a page aligned (mmap'd) image can be
+     * restored with bulk copies. Images are not portable between machines with different
+     * endianness or type sizes, headers record the sizes, so a mismatch is rejected.
+     */
+    namespace lru_image {
+        static constexpr unsigned int pool_magic = 0x4c525550; // 'LRUP'
+        static constexpr unsigned int cache_magic = 0x4c525543; // 'LRUC'
+        static constexpr unsigned int version = 1;
+        static constexpr unsigned long alignment = 16;
+
+        // image of the index of a pool, followed by `capacity` items
+        struct pool_header {
+            unsigned int magic, version;
+            unsigned int item_size, size_bits;
+            int capacity, max_size;
+            int mru_list, free_list, mru_size;
+            float load_factor;
+        };
+
+        // image of the objects of a cache, follows a pool image and is followed
+        // by `capacity` objects and then `capacity` weights, if weighted
+        struct cache_header {
+            unsigned int magic, version;
+            unsigned int object_size, weight_size;
+            int capacity;
+        };
+
+        inline unsigned long aligned(unsigned long size) {
+            return (size + alignment - 1) & ~(alignment - 1);
+        }
+
+        inline void copy_bytes(void * destination, const void * source, unsigned long size) {
+            auto * d = static_cast<unsigned char *>(destination);
+            const auto * s = static_cast<const unsigned char *>(source);
+            for (unsigned long ix = 0; ix < size; ++ix) d[ix] = s[ix];
+        }
+    }
+}
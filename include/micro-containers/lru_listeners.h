@@ -0,0 +1,69 @@
+/*========================================================================================
+ Copyright (2021), Tomer Shalev (tomer.shalev@gmail.com, https://github.com/HendrixString).
+ All Rights Reserved.
+ License is a custom open source semi-permissive license with the following guidelines:
+ 1. unless otherwise stated, derivative work and usage of this file is permitted and
+    should be credited to the project and the author of this project.
+ 2. Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+========================================================================================*/
+#pragma once
+
+#include "traits.h"
+#include "dynamic_array.h"
+
+namespace microc {
+    /**
+     * Eviction listener, that does nothing and compiles away. An eviction listener is a
+     * function struct, that implements `void operator()(machine_word key, object_type & object)`,
+     * it is invoked with the key and the object of an evicted entry, before the object is
+     * destructed (lru_cache) or reused (lru_pool).
+     */
+    struct lru_null_listener {
+        template<class machine_word, class object_type>
+        void operator()(machine_word, object_type &) const {}
+    };
+
+    /**
+     * Eviction listener, that moves evicted objects into a buffer, so they can be
+     * handed back in batches with drain(). The buffer memory is kept between drains.
+     * @tparam machine_word the machine word type of the keys
+     * @tparam object_type the object type
+     * @tparam Allocator allocator type
+     */
+    template<class machine_word, class object_type,
+             class Allocator=microc::std_allocator<char>>
+    class lru_eviction_buffer {
+    public:
+        using entry_type = pair<machine_word, object_type>;
+        using container_type = dynamic_array<entry_type, Allocator>;
+
+    private:
+        container_type _evicted;
+
+    public:
+        explicit lru_eviction_buffer(const Allocator & allocator = Allocator()) : _evicted(allocator) {}
+
+        void operator()(machine_word key, object_type & object) {
+            _evicted.push_back(entry_type(key, microc::traits::move(object)));
+        }
+
+        const container_type & evicted() const { return _evicted; }
+        microc::size_t size() const { return _evicted.size(); }
+
+        /**
+         * hand back all evicted entries since the last drain, and forget them
+         * @param callback implements `void operator()(machine_word key, object_type & object)`
+         * @return count of drained entries
+         */
+        template<class Callback>
+        microc::size_t drain(const Callback & callback) {
+            const auto count = _evicted.size();
+            for (auto & entry : _evicted) callback(entry.first, entry.second);
+            _evicted.clear();
+            return count;
+        }
+    };
+
+}
@@ -12,6 +12,7 @@
 
 #include "bits_linear_probe_lru_pool.h"
 #include "bits_robin_lru_pool.h"
+#include "lru_listeners.h"
 
 namespace microc {
 #define LRU_PRINT_SEQ 0
@@ -29,6 +30,8 @@ namespace microc {
      * 3. compact lookup and is perfect for CPU cache
      * 4. Objects can be constructed at init time, and are never destructed (but rather reused), unless the pool is destructed
      * 5. You can also defer construction to a later time.
+     * 6. Or construct lazily, every object is constructed when its slot is first handed out,
+     *    so construction time and touched memory scale with the used working set.
      * This uses a hash table with robin hood probing and in-place linked-list, that fits in a machine word.
      * and is very conservative with memory, which allows CPU caches to load many entries at once.
      *
@@ -42,12 +45,16 @@ namespace microc {
      * @tparam object_type The object type value to store
      * @tparam size_bits size of cache. 10 --> 2^10=1024 entries
      * @tparam machine_word the machine word type = short, int or long for key
+     * @tparam wide_index use the wide index layout of the pool, which allows upto 30 bits of size
+     * @tparam EvictionListener function struct `void operator()(machine_word key, object_type & object)`,
+     *         that is invoked with an evicted object before it is reused (only if objects are constructed)
      */
     template<class object_type, int size_bits=10,
-            class machine_word=long, class Allocator=void>
+            class machine_word=long, class Allocator=void, bool wide_index=false,
+            class EvictionListener=lru_null_listener>
     class lru_pool {
     private:
-        using pool_t = bits_robin_lru_pool<size_bits, machine_word, Allocator>;
+        using pool_t = bits_robin_lru_pool<size_bits, machine_word, Allocator, wide_index>;
         using _pool_iter = typename pool_t::const_iterator;
 
         template<class iter_value_type> struct iterator_t {
@@ -87,6 +94,8 @@ namespace microc {
         using size_type = int;
         using allocator_type = Allocator;
         using val_alloc = typename allocator_type::template rebind<value_type>::other;
+        using eviction_listener_type = EvictionListener;
+        using bits_alloc = typename allocator_type::template rebind<unsigned int>::other;
 
         struct pair { machine_word key; value_type & value; };
         struct const_pair { machine_word key; const value_type & value; };
@@ -103,6 +112,22 @@ namespace microc {
         value_type * _items;
         val_alloc _allocator;
         bool _are_items_constructed;
+        eviction_listener_type _listener;
+        // lazy mode, slots are copy-constructed from the prototype, a bit per slot
+        // tells if it was constructed already
+        value_type * _prototype;
+        unsigned int * _constructed;
+        bits_alloc _bits_allocator;
+        int _constructed_count;
+
+        static int bits_words(int count) { return (count + 31) >> 5; }
+        bool is_constructed(int idx) const { return (_constructed[idx>>5] >> (idx & 31)) & 1u; }
+        void construct_slot_if_needed(int idx) {
+            if(!_constructed || is_constructed(idx)) return;
+            ::new(_items + idx, microc_new::blah) value_type(*_prototype);
+            _constructed[idx>>5] |= 1u << (idx & 31);
+            ++_constructed_count;
+        }
 
     public:
         struct result_type {
@@ -118,14 +143,16 @@ namespace microc {
                  const allocator_type & allocator = allocator_type(),
                  Args && ...args) :
                  _pool(load_factor, allocator), _allocator(allocator), _items(nullptr),
-                 _are_items_constructed(false) {
+                 _are_items_constructed(false), _listener(), _prototype(nullptr),
+                 _constructed(nullptr), _bits_allocator(allocator), _constructed_count(0) {
             _items = _allocator.allocate(_pool.capacity());
             construct(microc::traits::forward<Args>(args)...);
         }
         explicit lru_pool(float load_factor=0.5f,
                           const allocator_type & allocator = allocator_type()) :
                           _pool(load_factor, allocator), _allocator(allocator), _items(nullptr),
-                          _are_items_constructed(false) {
+                          _are_items_constructed(false), _listener(), _prototype(nullptr),
+                          _constructed(nullptr), _bits_allocator(allocator), _constructed_count(0) {
             _items = _allocator.allocate(_pool.capacity());
         }
 
@@ -137,20 +164,68 @@ namespace microc {
         }
 
         allocator_type get_allocator() { return _allocator; }
-        constexpr int capacity() const { return _pool.capacity(); }
+        int capacity() const { return _pool.capacity(); }
         int size() const { return _pool.size(); }
         int maxSize() const { return _pool.maxSize(); }
+        // count of constructed objects, capacity() unless lazy
+        int constructedCount() const { return _are_items_constructed ? _constructed_count : 0; }
         void print(char order=1, int how_many=-1) { _pool.print(order, how_many); }
+#ifdef LRU_CACHE_ENABLE_STATS
+        // the counters of the underlying pool, a get() counts as a get_or_put()
+        lru_stats stats() const { return _pool.stats(); }
+        void reset_stats() { _pool.reset_stats(); }
+#endif
 
         bool has(machine_word key) const { return _pool.has(key); }
         result_type get(machine_word key) {
             const auto q = _pool.get_or_put(key);
+            // the evicted object might be the one we hand out, so notify before
+            if(q.removed_value!=-1 && _are_items_constructed)
+                _listener(q.removed_key, _items[q.removed_value]);
+            construct_slot_if_needed(q.value);
             return { _items[q.value], q.is_active };
         }
+        /**
+         * get a batch of objects, the pool prefetches the index entries of upcoming keys.
+         * Same as calling get for each key in order, see bits_robin_lru_pool::get_or_put_batch
+         * @param keys the keys
+         * @param count count of keys
+         * @param objects output array of count object pointers
+         * @param is_active (Optional) output array of count is_active flags
+         */
+        void get_batch(const machine_word * keys, int count, value_type ** objects,
+                       bool * is_active=nullptr) {
+            constexpr int chunk = 32;
+            typename pool_t::result_type results[chunk];
+            for (int done = 0; done < count; done += chunk) {
+                const int n = count - done < chunk ? count - done : chunk;
+                _pool.get_or_put_batch(keys + done, n, results);
+                for (int ix = 0; ix < n; ++ix) {
+                    const auto & q = results[ix];
+                    if(q.removed_value!=-1 && _are_items_constructed)
+                        _listener(q.removed_key, _items[q.removed_value]);
+                    construct_slot_if_needed(q.value);
+                    objects[done + ix] = _items + q.value;
+                    if(is_active) is_active[done + ix] = q.is_active;
+                }
+            }
+        }
+        eviction_listener_type & eviction_listener() { return _listener; }
+        const eviction_listener_type & eviction_listener() const { return _listener; }
+        void set_eviction_listener(const eviction_listener_type & listener) { _listener = listener; }
         void destruct() {
             if(!_are_items_constructed) return;
             for (int ix = 0; ix < capacity(); ++ix)
-                (_items + ix)->~value_type();
+                if(!_constructed || is_constructed(ix))
+                    (_items + ix)->~value_type();
+            if(_constructed) {
+                _prototype->~value_type();
+                _allocator.deallocate(_prototype);
+                _bits_allocator.deallocate(_constructed, bits_words(capacity()));
+                _prototype=nullptr;
+                _constructed=nullptr;
+            }
+            _constructed_count=0;
             _are_items_constructed=false;
         }
 
@@ -159,6 +234,24 @@ namespace microc {
             if(_are_items_constructed) destruct();
             for (int ix = 0; ix < capacity(); ++ix)
                 ::new(_items + ix, microc_new::blah) value_type(microc::traits::forward<Args>(args)...);
+            _constructed_count=capacity();
+            _are_items_constructed=true;
+        }
+        /**
+         * lazy construction, a prototype object is constructed now, and every slot is
+         * copy-constructed from it when it is first handed out, and then kept for reuse.
+         * Objects are destructed at destruct() or when the pool is destructed.
+         */
+        template<class ...Args>
+        void construct_lazily(Args && ...args) {
+            if(_are_items_constructed) destruct();
+            _prototype = _allocator.allocate(1);
+            ::new(_prototype, microc_new::blah) value_type(microc::traits::forward<Args>(args)...);
+            const int words = bits_words(capacity());
+            _constructed = _bits_allocator.allocate(words);
+            for (int ix = 0; ix < words; ++ix) _constructed[ix] = 0;
+            // slots, that are active already, are handed out, so construct them now
+            for (auto kv : _pool) construct_slot_if_needed(kv.value);
             _are_items_constructed=true;
         }
         void clear() {
@@ -0,0 +1,47 @@
+/*========================================================================================
+ Copyright (2021), Tomer Shalev (tomer.shalev@gmail.com, https://github.com/HendrixString).
+ All Rights Reserved.
+ License is a custom open source semi-permissive license with the following guidelines:
+ 1. unless otherwise stated, derivative work and usage of this file is permitted and
+    should be credited to the project and the author of this project.
+ 2. Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+========================================================================================*/
+#pragma once
+
+// define LRU_CACHE_ENABLE_STATS before including the lru containers to count
+// hits, misses etc.. When not defined, counting and the stats API are compiled out.
+//#define LRU_CACHE_ENABLE_STATS
+#ifdef LRU_CACHE_ENABLE_STATS
+#define LRU_STATS_COUNT(statement) statement;
+#else
+#define LRU_STATS_COUNT(statement)
+#endif
+
+namespace microc {
+    /**
+     * Counters of the lru containers, that are returned as a snapshot
+     */
+    struct lru_stats {
+        // lookups, that found or did not find the key
+        unsigned long hits, misses;
+        // new keys, that were inserted
+        unsigned long inserts;
+        // keys, that were removed by the LRU policy, and keys, that were removed explicitly
+        unsigned long evictions, removals;
+        // total probe distance of get_or_put and how many calls it was measured over
+        unsigned long probe_distance, probes;
+
+        lru_stats() : hits(0), misses(0), inserts(0), evictions(0), removals(0),
+                      probe_distance(0), probes(0) {}
+        float hit_ratio() const {
+            const auto lookups = hits + misses;
+            return lookups ? float(hits)/float(lookups) : 0.0f;
+        }
+        float average_probe_distance() const {
+            return probes ? float(probe_distance)/float(probes) : 0.0f;
+        }
+        void reset() { *this = lru_stats(); }
+    };
+}
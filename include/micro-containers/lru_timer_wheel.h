@@ -0,0 +1,159 @@
+/*========================================================================================
+ Copyright (2021), Tomer Shalev (tomer.shalev@gmail.com, https://github.com/HendrixString).
+ All Rights Reserved.
+ License is a custom open source semi-permissive license with the following guidelines:
+ 1. unless otherwise stated, derivative work and usage of this file is permitted and
+    should be credited to the project and the author of this project.
+ 2. Unless required by applicable law or agreed to in writing, software
+    distributed under the License is distributed on an "AS IS" BASIS,
+    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+========================================================================================*/
+#pragma once
+
+#include "traits.h"
+
+namespace microc {
+    /**
+     * Hashed timer wheel for the expiry of pool values (indices).
+     * Every value owns one entry with its key, expiry time and in-place links, so an entry is
+     * linked into the bucket of its expiry time without any allocation. Buckets are swept
+     * incrementally, and entries, that belong to a later revolution of the wheel, are skipped.
+     * The time unit is whatever the user clock produces, resolution is the time span of a bucket.
+     *
+     * NOTES:
+     * - memory is allocated once, at init()
+     * - entries with `never` expiry time are not linked at all
+     *
+     * @tparam machine_word the machine word type of the keys
+     * @tparam Allocator allocator type
+     */
+    template<class machine_word=long, class Allocator=void>
+    class lru_timer_wheel {
+    public:
+        using time_type = unsigned long;
+        static constexpr time_type never = ~time_type(0);
+        static constexpr int wheel_bits = 8;
+        static constexpr int wheel_size = 1<<wheel_bits;
+
+    private:
+        struct entry_t {
+            machine_word key;
+            time_type at;
+            int prev, next;
+        };
+        using entry_alloc = typename Allocator::template rebind<entry_t>::other;
+        using head_alloc = typename Allocator::template rebind<int>::other;
+
+        entry_t * _entries;
+        int * _heads;
+        int _count;
+        // the time of the bucket, that is being swept, and the next entry to examine in it
+        time_type _sweep_time;
+        int _cursor;
+        time_type _resolution;
+        entry_alloc _entry_allocator;
+        head_alloc _head_allocator;
+
+        int bucket_of(time_type at) const { return int((at / _resolution) & (wheel_size-1)); }
+
+    public:
+        explicit lru_timer_wheel(const Allocator & allocator = Allocator()) :
+                _entries(nullptr), _heads(nullptr), _count(0), _sweep_time(0), _cursor(-1),
+                _resolution(1), _entry_allocator(allocator), _head_allocator(allocator) {}
+        ~lru_timer_wheel() { drain(); }
+
+        /**
+         * allocate entries for values in [0, count)
+         */
+        void init(int count) {
+            drain();
+            _count = count;
+            _entries = _entry_allocator.allocate(count);
+            _heads = _head_allocator.allocate(wheel_size);
+            for (int ix = 0; ix < count; ++ix) _entries[ix].at = never;
+            clear();
+        }
+        void drain() {
+            if(_entries) _entry_allocator.deallocate(_entries, _count);
+            if(_heads) _head_allocator.deallocate(_heads, wheel_size);
+            _entries = nullptr; _heads = nullptr; _count = 0;
+        }
+        // unlinks everything, expiry times of entries are kept, so they can be re-linked
+        void clear() {
+            for (int ix = 0; ix < wheel_size; ++ix) _heads[ix] = -1;
+            _cursor = -1;
+        }
+        void swap(lru_timer_wheel & other) noexcept {
+            entry_t * entries = _entries; _entries = other._entries; other._entries = entries;
+            int * heads = _heads; _heads = other._heads; other._heads = heads;
+            int ii = _count; _count = other._count; other._count = ii;
+            ii = _cursor; _cursor = other._cursor; other._cursor = ii;
+            time_type tt = _sweep_time; _sweep_time = other._sweep_time; other._sweep_time = tt;
+            tt = _resolution; _resolution = other._resolution; other._resolution = tt;
+        }
+
+        time_type resolution() const { return _resolution; }
+        void set_resolution(time_type resolution) { _resolution = resolution ? resolution : 1; }
+        machine_word key_of(int val) const { return _entries[val].key; }
+        time_type expiry_of(int val) const { return _entries[val].at; }
+        bool is_expired(int val, time_type now) const { return _entries[val].at <= now; }
+
+        void link(int val, machine_word key, time_type at) {
+            auto & entry = _entries[val];
+            entry.key = key;
+            entry.at = at;
+            if(at==never) return;
+            int & head = _heads[bucket_of(at)];
+            entry.prev = -1;
+            entry.next = head;
+            if(head!=-1) _entries[head].prev = val;
+            head = val;
+        }
+        // re-link an unlinked entry with its recorded key and expiry time
+        void relink(int val) { link(val, _entries[val].key, _entries[val].at); }
+        void unlink(int val) {
+            auto & entry = _entries[val];
+            if(entry.at==never) return;
+            if(val==_cursor) _cursor = entry.next;
+            if(entry.prev!=-1) _entries[entry.prev].next = entry.next;
+            else _heads[bucket_of(entry.at)] = entry.next;
+            if(entry.next!=-1) _entries[entry.next].prev = entry.prev;
+            entry.at = never;
+        }
+
+        /**
+         * sweep buckets up to now, and report expired values.
+         * @param now the current time
+         * @param budget how many entries/buckets to examine at most
+         * @param on_expired callback with the expired value, it has to unlink it
+         * @return count of expired values
+         */
+        template<class Callback>
+        int expire(time_type now, int budget, const Callback & on_expired) {
+            int count = 0;
+            int idx = _cursor==-1 ? _heads[bucket_of(_sweep_time)] : _cursor;
+            while(budget-- > 0) {
+                if(idx==-1) {
+                    // current bucket is done, move to the next one only if its time span has passed,
+                    // otherwise, it will be scanned again at the next sweep
+                    if(_sweep_time/_resolution >= now/_resolution) break;
+                    const time_type span = _resolution * wheel_size;
+                    // a full revolution visits all the buckets
+                    if(now - _sweep_time > span) _sweep_time = now - span;
+                    else _sweep_time += _resolution;
+                    idx = _heads[bucket_of(_sweep_time)];
+                    continue;
+                }
+                const int next = _entries[idx].next;
+                if(_entries[idx].at <= now) {
+                    on_expired(idx);
+                    ++count;
+                }
+                idx = next;
+            }
+            _cursor = idx;
+            return count;
+        }
+    };
+
+}
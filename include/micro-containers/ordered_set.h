@@ -27,15 +27,20 @@ namespace microc {
     /**
      * Ordered Set is an ordered associative data structure
      * Notes:
-     * - Most algorithms use recursion, so there is a stack memory cost of O(log(n))
+     * - insert and erase are iterative, with a bounded path stack (see avl_tree)
+     * - The tree is an avl_tree by default, b_tree_backend<Order> (see b_tree.h) stores items
+     *   in arrays, which is friendlier to the cache for large sets, but then iterators are
+     *   invalidated by insert and erase
      * - This class is Allocator-Aware
      * @tparam Key the item type, that the tree stores
      * @tparam Compare compare structure or lambda for item
      * @tparam Allocator allocator type
+     * @tparam Backend selects the tree, avl_tree_backend, avl_order_statistics_backend or b_tree_backend<Order>
      */
     template<class Key,
              class Compare=ordered_set_less<Key>,
-             class Allocator=microc::std_allocator<char>>
+             class Allocator=microc::std_allocator<char>,
+             class Backend=avl_tree_backend>
     class ordered_set {
     public:
         using key_type = Key;
@@ -69,7 +74,7 @@ namespace microc {
         };
 
     public:
-        using tree_type = avl_tree<value_type, value_type, value_compare, avl_key_extract<value_type, value_type>, Allocator>;
+        using tree_type = typename Backend::template tree<value_type, value_type, value_compare, avl_key_extract<value_type, value_type>, Allocator>;
         using node_type = typename tree_type::node_type;
         using iterator = iterator_t<value_type &, typename tree_type::iterator>;
         using const_iterator = iterator_t<const value_type &, typename tree_type::const_iterator>;
@@ -161,6 +166,28 @@ namespace microc {
             return iter_dict;
         }
         bool contains(const Key& key) const { return _tree.contains(key); }
+        // first item, that is not less than the key
+        iterator lower_bound(const Key& key) { return iterator(_tree.lower_bound(key)); }
+        const_iterator lower_bound(const Key& key) const { return const_iterator(_tree.lower_bound(key)); }
+        // first item, that is greater than the key
+        iterator upper_bound(const Key& key) { return iterator(_tree.upper_bound(key)); }
+        const_iterator upper_bound(const Key& key) const { return const_iterator(_tree.upper_bound(key)); }
+        // the range of the items of the key, empty or one item
+        pair<iterator, iterator> equal_range(const Key& key) {
+            return pair<iterator, iterator>(lower_bound(key), upper_bound(key));
+        }
+        pair<const_iterator, const_iterator> equal_range(const Key& key) const {
+            return pair<const_iterator, const_iterator>(lower_bound(key), upper_bound(key));
+        }
+
+        // order statistics, need avl_order_statistics_backend
+        // count of keys less than a key
+        size_type rank(const Key& key) const { return _tree.rank_by_key(key); }
+        // the item at an index in order, or end
+        iterator nth(size_type index) { return iterator(_tree.select(index)); }
+        const_iterator nth(size_type index) const { return const_iterator(_tree.select(index)); }
+        // count of keys in [lo, hi)
+        size_type count_range(const Key& lo, const Key& hi) const { return _tree.count_range_by_key(lo, hi); }
 
         // Modifiers
         void clear() noexcept { _tree.clear(); }
@@ -172,6 +199,18 @@ namespace microc {
             auto result = _tree.insert(microc::traits::move(value));
             return pair<iterator, bool>(iterator(result.first), result.second);
         }
+        // insert with a hint, an avl backend links the item next to a correct hint without
+        // a search from the root (see avl_tree::insert_hint), returns the item of the key
+        iterator insert(const_iterator hint, const value_type& value) {
+            return iterator(_tree.insert_hint(hint._pos, value).first);
+        }
+        iterator insert(const_iterator hint, value_type && value) {
+            return iterator(_tree.insert_hint(hint._pos, microc::traits::move(value)).first);
+        }
+        template<class... Args>
+        iterator emplace_hint(const_iterator hint, Args &&... args) {
+            return iterator(_tree.insert_emplace_hint(hint._pos, microc::traits::forward<Args>(args)...).first);
+        }
     private:
         template<class A, class B>
         using match_t = microc::traits::enable_if_t<
@@ -187,6 +226,37 @@ namespace microc {
             InputIt current(first);
             while(current!=last) { insert(*current); current++; }
         }
+        /**
+         * Replace the items with a sorted range in linear time (see avl_tree::assign_sorted)
+         * @param first,last forward iterators of items, sorted by key without duplicates
+         * @param verify check the order first, and keep the items as they are if it is not sorted
+         * @return false if verify failed
+         */
+        template<class ForwardIt>
+        bool assign_sorted(ForwardIt first, ForwardIt last, bool verify=true)
+        { return _tree.assign_sorted(first, last, verify); }
+        /**
+         * Insert a sorted range, that may interleave with the items (see avl_tree::insert_sorted)
+         * @param first,last forward iterators of items, sorted by key without duplicates
+         * @param verify check the order first, and keep the items as they are if it is not sorted
+         * @return false if verify failed
+         */
+        template<class ForwardIt>
+        bool insert_sorted(ForwardIt first, ForwardIt last, bool verify=true)
+        { return _tree.insert_sorted(first, last, verify); }
+        // split and set operations relink nodes, they need an avl backend (see avl_tree)
+        // this keeps the keys less than the key, returns the rest
+        ordered_set split(const Key& key) {
+            ordered_set right(_key_compare, get_allocator());
+            right._tree = _tree.split(key);
+            return right;
+        }
+        // append other, whose keys all succeed the keys of this, other is left empty
+        void join(ordered_set & other) { _tree.join(other._tree); }
+        // move the items of other in, keys in both keep the items of this, other is left empty
+        void union_with(ordered_set & other) { _tree.union_with(other._tree); }
+        void intersect_with(const ordered_set & other) { _tree.intersect_with(other._tree); }
+        void difference_with(const ordered_set & other) { _tree.difference_with(other._tree); }
         unsigned erase(const Key& key) {
             auto tree_size = _tree.size();
             auto tree_iter = _tree.remove(key);
@@ -194,18 +264,19 @@ namespace microc {
         }
         iterator erase(iterator pos) { return iterator(_tree.remove(*pos)); }
         iterator erase(const_iterator pos) { return iterator(_tree.remove(*pos)); }
+        // an avl backend splits out the range and joins the rest, in O(log(n) + k)
         iterator erase(const_iterator first, const_iterator last) {
-            const_iterator current(first);
-            while (current!=last) current=erase(current);
-            return current;
+            return iterator(_tree.remove_range(first._pos, last._pos));
         }
+        // erase the items with keys in [lo, hi), returns the count of erased items
+        size_type erase_range(const Key& lo, const Key& hi) { return _tree.erase_range(lo, hi); }
     };
 
-    template<class Key, class Compare, class Allocator>
-    bool operator==(const ordered_set<Key, Compare, Allocator>& lhs,
-                    const ordered_set<Key, Compare, Allocator>& rhs ) {
+    template<class Key, class Compare, class Allocator, class Backend>
+    bool operator==(const ordered_set<Key, Compare, Allocator, Backend>& lhs,
+                    const ordered_set<Key, Compare, Allocator, Backend>& rhs ) {
         if(!(lhs.size()==rhs.size())) return false;
-        using size_type = typename ordered_set<Key, Compare, Allocator>::size_type;
+        using size_type = typename ordered_set<Key, Compare, Allocator, Backend>::size_type;
         for (size_type ix = 0; ix < lhs.size(); ++ix) {
             if(!(lhs[ix]==rhs[ix])) return false;
         }
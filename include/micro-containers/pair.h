@@ -31,15 +31,15 @@ namespace microc {
 
         };
         pair(const pair& p) : first(p.first), second(p.second) {};
-        pair(pair&& p)  noexcept : first(microc::traits::move(p.first)), second(microc::traits::move(p.second)) {};
+        pair(pair&& p)  noexcept : first(microc::traits::forward<T1>(p.first)), second(microc::traits::forward<T2>(p.second)) {};
         pair& operator=(const pair& other) {
             first = other.first;
             second = other.second;
             return *this;
         }
         pair& operator=(pair&& o) noexcept {
-            first = microc::traits::move(o.first);
-            second = microc::traits::move(o.second);
+            first = microc::traits::forward<T1>(o.first);
+            second = microc::traits::forward<T2>(o.second);
             return *this;
         };
     };
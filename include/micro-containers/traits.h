@@ -108,10 +108,23 @@ namespace microc {
 //        template <typename T>
 //        struct is_allocator_aware <T, decltype((void) T().get_allocator(), 0)> : microc::traits::true_type { };
 
+        // compiler intrinsic, supported by gcc, clang and msvc
+        template<class T> struct is_trivially_copyable {
+            constexpr static bool value = __is_trivially_copyable(T);
+        };
+
         template<class T> struct is_integral { constexpr static bool value = false; };
         template<> struct is_integral<unsigned> { constexpr static bool value = true; };
         template<> struct is_integral<signed> { constexpr static bool value = true; };
         template<> struct is_integral<char> { constexpr static bool value = true; };
+        template<> struct is_integral<signed char> { constexpr static bool value = true; };
+        template<> struct is_integral<unsigned char> { constexpr static bool value = true; };
+        template<> struct is_integral<short> { constexpr static bool value = true; };
+        template<> struct is_integral<unsigned short> { constexpr static bool value = true; };
+        template<> struct is_integral<long> { constexpr static bool value = true; };
+        template<> struct is_integral<unsigned long> { constexpr static bool value = true; };
+        template<> struct is_integral<long long> { constexpr static bool value = true; };
+        template<> struct is_integral<unsigned long long> { constexpr static bool value = true; };
 
         template<typename _Tp, typename _Up = _Tp&&>
         _Up __declval(int);  // (1)